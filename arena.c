@@ -0,0 +1,101 @@
+#include <SDL3/SDL.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+Arena levelArena;
+
+static ArenaBlock* createBlock(size_t size) {
+	ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+	if (block == NULL) {
+		SDL_Log("Couldn't allocate %zu byte arena block", size);
+		exit(1);
+	}
+
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	block->data = (unsigned char*)(block + 1);
+	return block;
+}
+
+// Offset in a block where an allocation of this alignment can start
+static size_t alignedOffset(const ArenaBlock *block, size_t alignment) {
+	const uintptr_t address = (uintptr_t)(block->data + block->used);
+	const uintptr_t aligned = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	return block->used + (aligned - address);
+}
+
+void* arenaAlloc(Arena *arena, size_t size, size_t alignment) {
+	if (alignment == 0) alignment = 1;
+
+	if (arena->current == NULL) {
+		arena->first = arena->current = createBlock(ARENA_BLOCK_SIZE);
+	}
+
+	ArenaBlock *block = arena->current;
+	size_t offset = alignedOffset(block, alignment);
+
+	// Move on to the next block, reusing ones kept from before a rewind when they fit
+	while (offset + size > block->size) {
+		ArenaBlock *next = block->next;
+
+		if (next == NULL || next->size < size + alignment) {
+			size_t blockSize = ARENA_BLOCK_SIZE;
+			while (blockSize < size + alignment) blockSize *= 2;
+
+			ArenaBlock *grown = createBlock(blockSize);
+			grown->next = next;
+			block->next = grown;
+			next = grown;
+		}
+
+		block = next;
+		block->used = 0;
+		offset = alignedOffset(block, alignment);
+	}
+
+	arena->current = block;
+	block->used = offset + size;
+	return block->data + offset;
+}
+
+void* arenaCalloc(Arena *arena, size_t count, size_t size) {
+	void *memory = arenaAlloc(arena, count * size, 16);
+	memset(memory, 0, count * size);
+	return memory;
+}
+
+ArenaMark arenaMark(Arena *arena) {
+	if (arena->current == NULL) return (ArenaMark){NULL, 0};
+	return (ArenaMark){arena->current, arena->current->used};
+}
+
+void arenaRewind(Arena *arena, ArenaMark mark) {
+	if (mark.block == NULL) {
+		arenaReset(arena);
+		return;
+	}
+
+	arena->current = mark.block;
+	mark.block->used = mark.used;
+}
+
+void arenaReset(Arena *arena) {
+	arena->current = arena->first;
+	if (arena->first != NULL) arena->first->used = 0;
+}
+
+void destroyArena(Arena *arena) {
+	ArenaBlock *block = arena->first;
+
+	while (block != NULL) {
+		ArenaBlock *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	arena->first = arena->current = NULL;
+}
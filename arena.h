@@ -0,0 +1,50 @@
+#pragma once
+#include <stddef.h>
+
+// Size of the first block of an arena, later blocks are at least this big
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+// A chunk of memory handed out front to back
+typedef struct ArenaBlock {
+	struct ArenaBlock *next;
+	size_t size;
+	size_t used;
+	unsigned char *data;
+} ArenaBlock;
+
+// Bump allocator made of a chain of blocks. Nothing is freed on its own,
+// everything after a mark is released at once by rewinding to it.
+// Blocks are kept after a rewind and reused by the next allocations
+typedef struct Arena {
+	ArenaBlock *first;
+	ArenaBlock *current;
+} Arena;
+
+// A point in an arena to rewind back to
+typedef struct ArenaMark {
+	ArenaBlock *block;
+	size_t used;
+} ArenaMark;
+
+// Everything that lives as long as the level being played: the object stores, the cull
+// grids and the restart snapshot. Reset when the level is cleaned up. Box2D keeps its own
+// allocator, it frees and reuses memory all through a level and gives it back with its world
+extern Arena levelArena;
+
+// Returns size bytes aligned to alignment (a power of two), exits if out of memory
+void* arenaAlloc(Arena *arena, size_t size, size_t alignment);
+
+// Returns a zeroed array of count items of the given size
+void* arenaCalloc(Arena *arena, size_t count, size_t size);
+
+// Current position, allocations made after it are released by arenaRewind()
+ArenaMark arenaMark(Arena *arena);
+
+// Releases everything allocated after the mark
+void arenaRewind(Arena *arena, ArenaMark mark);
+
+// Releases everything, keeping the blocks for reuse
+void arenaReset(Arena *arena);
+
+// Frees the blocks themselves
+void destroyArena(Arena *arena);
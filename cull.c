@@ -0,0 +1,111 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game.h"
+#include "cull.h"
+#include "arena.h"
+
+static int clampCell(float value, float cellSize, int cells) {
+	int cell = floorf(value / cellSize);
+
+	if (cell < 0) return 0;
+	if (cell >= cells) return cells - 1;
+	return cell;
+}
+
+void cellRange(const CullIndex *index, SDL_FRect rect, int *x0, int *y0, int *x1, int *y1) {
+	*x0 = clampCell(rect.x, index->cellSize, index->columns);
+	*y0 = clampCell(rect.y, index->cellSize, index->rows);
+	*x1 = clampCell(rect.x + rect.w, index->cellSize, index->columns);
+	*y1 = clampCell(rect.y + rect.h, index->cellSize, index->rows);
+}
+
+static int compareInt(const void *a, const void *b) {
+	return *(const int*)a - *(const int*)b;
+}
+
+bool rectsOverlap(SDL_FRect a, SDL_FRect b) {
+	return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void buildCullIndex(CullIndex *index, const SDL_FRect *rects, int count, float levelWidth, float levelHeight, float cellSize, Arena *arena) {
+	index->cellSize = cellSize;
+	index->columns = ceilf(levelWidth / cellSize);
+	index->rows = ceilf(levelHeight / cellSize);
+	if (index->columns < 1) index->columns = 1;
+	if (index->rows < 1) index->rows = 1;
+
+	const int cells = index->columns * index->rows;
+	index->cellStart = arenaCalloc(arena, cells + 1, sizeof(int));
+	index->visible = arenaAlloc(arena, sizeof(int) * (count > 0 ? count : 1), _Alignof(int));
+
+	// First pass: count how many rectangles land in each cell
+	int items = 0;
+	for (int i = 0; i < count; i++) {
+		int x0, y0, x1, y1;
+		cellRange(index, rects[i], &x0, &y0, &x1, &y1);
+
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) index->cellStart[y * index->columns + x + 1]++;
+		}
+		items += (x1 - x0 + 1) * (y1 - y0 + 1);
+	}
+
+	// Turn the counts into where each cell's items start
+	for (int c = 0; c < cells; c++) index->cellStart[c + 1] += index->cellStart[c];
+
+	// Second pass: file every rectangle under each cell it covers
+	index->items = arenaAlloc(arena, sizeof(CullItem) * (items > 0 ? items : 1), _Alignof(CullItem));
+
+	// Scratch space, given back to the arena once the grid is filled
+	const ArenaMark scratch = arenaMark(arena);
+	int *fill = arenaAlloc(arena, sizeof(int) * cells, _Alignof(int));
+	memcpy(fill, index->cellStart, sizeof(int) * cells);
+
+	for (int i = 0; i < count; i++) {
+		int x0, y0, x1, y1;
+		cellRange(index, rects[i], &x0, &y0, &x1, &y1);
+
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				index->items[fill[y * index->columns + x]++] = (CullItem){i, x0, y0};
+			}
+		}
+	}
+
+	arenaRewind(arena, scratch);
+}
+
+void destroyCullIndex(CullIndex *index) {
+	// The grid's arrays go with its arena
+	memset(index, 0, sizeof(CullIndex));
+}
+
+int cullRects(CullIndex *index, const SDL_FRect *rects, SDL_FRect view) {
+	int qx0, qy0, qx1, qy1;
+	cellRange(index, view, &qx0, &qy0, &qx1, &qy1);
+
+	int count = 0;
+	for (int y = qy0; y <= qy1; y++) {
+		for (int x = qx0; x <= qx1; x++) {
+			const int cell = y * index->columns + x;
+
+			for (int i = index->cellStart[cell]; i < index->cellStart[cell + 1]; i++) {
+				const CullItem item = index->items[i];
+
+				// A rectangle spanning several cells is only reported from the first
+				// of its cells that is inside the view, so it is never drawn twice
+				const int ownerX = item.cellX > qx0 ? item.cellX : qx0;
+				const int ownerY = item.cellY > qy0 ? item.cellY : qy0;
+				if (ownerX != x || ownerY != y) continue;
+
+				if (rectsOverlap(rects[item.rect], view)) index->visible[count++] = item.rect;
+			}
+		}
+	}
+
+	// Keep the rectangles in their original order
+	qsort(index->visible, count, sizeof(int), compareInt);
+	return count;
+}
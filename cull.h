@@ -0,0 +1,39 @@
+#pragma once
+#include "game.h"
+#include "arena.h"
+
+// Size of a grid cell in pixels for culling what is drawn
+const static float CULL_CELL_SIZE = 256.0f;
+
+// A rectangle filed under a grid cell, with the first cell it covers
+typedef struct CullItem {
+	int rect;
+	int cellX;
+	int cellY;
+} CullItem;
+
+// Uniform grid over rectangles that never move, like static and collectible objects
+typedef struct CullIndex {
+	float cellSize;
+	int columns;
+	int rows;
+	int *cellStart;
+	CullItem *items;
+	int *visible;
+} CullIndex;
+
+// Builds the grid over a level's rectangles in arena, positions and cellSize are in level pixels
+void buildCullIndex(CullIndex *index, const SDL_FRect *rects, int count, float levelWidth, float levelHeight, float cellSize, Arena *arena);
+
+// The range of cells a rectangle covers, clamped to the grid
+void cellRange(const CullIndex *index, SDL_FRect rect, int *x0, int *y0, int *x1, int *y1);
+
+// Forgets the grid, its arrays are released with its arena
+void destroyCullIndex(CullIndex *index);
+
+// Finds the rectangles overlapping view (in level pixels)
+// Fills index->visible with their indices in order and returns how many there are
+int cullRects(CullIndex *index, const SDL_FRect *rects, SDL_FRect view);
+
+// Checks if two rectangles overlap
+bool rectsOverlap(SDL_FRect a, SDL_FRect b);
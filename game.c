@@ -19,11 +19,50 @@
 #include "game.h" 
 #include "utils.h"
 #include "render.h"
+#include "scheduler.h"
+#include "level.h"
+#include "cull.h"
+#include "store.h"
+#include "profiler.h"
+#include "arena.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "loader.h"
+#include "stream.h"
+#include "tiles.h"
+#include "pacer.h"
+#include "pipeline.h"
+#include "pool.h"
 
 World world;
 Player player;
 Object* objects;
 
+// The loaded level file that owns objects
+static LevelFile levelFile;
+
+// Spatial indices used to only draw the still objects the camera can see
+static CullIndex staticCull;
+static CullIndex collectibleCull;
+
+// The statics drawn into textures as they come into view
+static StaticTiles staticTiles;
+
+// Creates the bodies of the chunks around the player
+static Streamer streamer;
+
+// Debris bodies, made disabled with the level and turned on as they are thrown out
+static EntityPool debris;
+
+// The level as it was right after loading, restored to restart it
+static LevelSnapshot levelStart;
+
+// Frames snapshotted so far, the bodies that moved are tracked per frame
+static Uint64 snapshotFrame = 1;
+
+// Bumped when the level is swapped or restarted, snapshots taken before are filled again in full
+static Uint64 snapshotEpoch = 1;
+
 void initSDL() {
 	// Initalize the SDL library
     if (!SDL_Init(SDL_INIT_VIDEO)) {
@@ -39,110 +78,158 @@ void initSDL() {
 
 	// Gets a pointer to an array that defines what keys are being pressed
 	world.keys = SDL_GetKeyboardState(NULL);
-	world.lastTime = SDL_GetTicks();
+	world.lastTime = SDL_GetTicksNS();
+}
+
+// Set up level information from the file
+static void setUpLevelInfo(LevelData *data) {
+	Level *level = &data->level;
+	memset(level, 0, sizeof(Level));
+
+	level->levelWidth = data->file.levelWidth;
+	level->levelHeight = data->file.levelHeight;
+	level->cameraLeftOffset = (float)WIDTH / 2;
+	level->cameraRightOffset = level->levelWidth - level->cameraLeftOffset;
+	level->cameraBottomOffset = (float)HEIGHT / 2;
+	level->cameraTopOffset = level->levelHeight - level->cameraBottomOffset;
+	level->collectiblesNeeded = data->file.collectiblesNeeded;
+}
+
+// Set up Objects with SDL information 
+static void connectSDLtoObjects(LevelData *data) {
+	// Copy the level objects into the per type stores, with their SDL Frects
+	buildObjectStores(&data->stores, data->file.objects, data->file.numberOfObjects, &data->arena);
+
+	// Index the objects that never move by where they are in the level
+	const ObjectStores *s = &data->stores;
+	buildCullIndex(&data->staticCull, s->statics.rect, s->statics.count, data->level.levelWidth, data->level.levelHeight, CULL_CELL_SIZE, &data->arena);
+	buildCullIndex(&data->collectibleCull, s->collectibles.rect, s->collectibles.count, data->level.levelWidth, data->level.levelHeight, CULL_CELL_SIZE, &data->arena);
 }
 
-void connectSDLtoObjects() {
-	// Set the defined pixel units in initGameObjects() to SDL Frect 
-	for (int i = 0; i < world.numberOfObjects; i++) {
-		objects[i].rect.x = objects[i].p.x;
-		objects[i].rect.y = objects[i].p.y;
-		objects[i].rect.w = objects[i].p.w;
-		objects[i].rect.h = objects[i].p.h;
+void createObjectBody(b2WorldId worldId, ObjectStores *target, Object *obj) {
+	ObjectStore* store = storeIn(target, obj->type);
+	const int slot = obj->slot;
+
+	// Create Body definition
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+
+	// SDL position and Box2D positions are different, so we convert between our pixel positioning to
+	// Box2D positioning here
+	bodyDef.position = SDLPositionToBox2D(obj);
+	bodyDef.fixedRotation = true;
+
+	// Move events point back at the object so its store can be updated
+	bodyDef.userData = obj;
+
+	// If dealing with a dynamic object, tell box2D we need physics!!!
+	if (obj->type == DYNAMIC) bodyDef.type = b2_dynamicBody;
+	if (obj->type == KINEMATIC) bodyDef.type = b2_kinematicBody;
+
+	// Moving bodies other than the player wait until the streamer finds them in range
+	if ((obj->type == DYNAMIC && slot != 0) || obj->type == KINEMATIC) bodyDef.isEnabled = false;
+
+	// Create Body
+	const b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
+	store->bodyId[slot] = bodyId;
+	if (store->position) store->position[slot] = store->previousPosition[slot] = bodyDef.position;
+
+	// Convert between SDL pixel to Box2D meter
+	b2Vec2 size = SDLSizeToBox2D(obj);
+
+	// Set mass Data
+	b2MassData mass;
+	mass.mass = 40.0f;
+	mass.center = (b2Vec2){0, 0};
+	mass.rotationalInertia = 0.0;
+	b2Body_SetMassData(bodyId, mass); 
+
+	// Create Polygon Shape
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.density = 1.0f;
+	shapeDef.friction = 0.5f;
+
+	// Every shape points back at its object, so events can find it directly
+	shapeDef.userData = obj;
+
+	if (obj->type == KINEMATIC) shapeDef.friction = 1.0f;
+
+	// Kept apart from the level so debris can skip the player and boxes
+	if (obj->type == DYNAMIC) shapeDef.filter.categoryBits = CATEGORY_DYNAMIC;
+
+	// Add shape to polygon depending on object type
+	if (obj->type != COLLECTIBLE) {
+		// Make object shape depending on what type of object we are dealing with
+		b2Polygon polygon = b2MakeBox(size.x, size.y);
+
+		// Add polygon box to our shape
+		b2CreatePolygonShape(bodyId, &shapeDef, &polygon);
+		
+	} else {
+		// Create circle
+		b2Circle circle;
+		circle.radius = size.x; 
+		circle.center = (b2Vec2){0,0}; 
+
+		// Set is sensor to turn of collisions
+		shapeDef.isSensor = true;
+
+		// Add circle to our shape
+		b2CreateCircleShape(bodyId, &shapeDef, &circle);
 	}
 }
 
-void initBox2D() {
+// Creates the level's Box2D world with the moving bodies, and the still bodies around the player
+static void initBox2D(LevelData *data) {
 	// Create Box2d World
 	b2WorldDef worldDef = b2DefaultWorldDef();
 	worldDef.gravity = (b2Vec2){0.0f, -10.0f};
-	world.worldId = b2CreateWorld(&worldDef);
-
-	// Create Static bodies
-	for (int i = 0; i < world.numberOfObjects; i++) {
-		Object* obj = &objects[i];
-
-		// Create Body definition
-		b2BodyDef bodyDef = b2DefaultBodyDef();
-
-		// SDL position and Box2D positions are different, so we convert between our pixel positioning to
-		// Box2D positioning here
-		bodyDef.position = SDLPositionToBox2D(obj);
-		bodyDef.fixedRotation = true;
-
-		// If dealing with a dynamic object, tell box2D we need physics!!!
-		if (obj->type == DYNAMIC) bodyDef.type = b2_dynamicBody;
-		if (obj->type == KINEMATIC) bodyDef.type = b2_kinematicBody;
-
-		// Create Body
-		obj->bodyId = b2CreateBody(world.worldId, &bodyDef);
-
-		// Convert between SDL pixel to Box2D meter
-		b2Vec2 size = SDLSizeToBox2D(obj);
-
-		// Set mass Data
-		b2MassData mass;
-		mass.mass = 40.0f;
-		mass.center = (b2Vec2){0, 0};
-		mass.rotationalInertia = 0.0;
-		b2Body_SetMassData(obj->bodyId, mass); 
-
-		// Create Polygon Shape
-		b2ShapeDef shapeDef = b2DefaultShapeDef();
-		shapeDef.density = 1.0f;
-		shapeDef.friction = 0.5f;
-
-		if (obj->type == KINEMATIC) shapeDef.friction = 1.0f;
-
-		// Add shape to polygon depending on object type
-		if (obj->type != COLLECTIBLE) {
-			// Make object shape depending on what type of object we are dealing with
-			obj->polygon = b2MakeBox(size.x, size.y);
-
-			// Add polygon box to our shape
-			obj->shapeId = b2CreatePolygonShape(obj->bodyId, &shapeDef, &obj->polygon);
-			
-		} else {
-			// Create circle
-			b2Circle circle;
-			circle.radius = size.x; 
-			circle.center = (b2Vec2){0,0}; 
-
-			// Set is sensor to turn of collisions
-			shapeDef.isSensor = true;
-			shapeDef.userData = "collectible";
-
-			// Add circle to our shape
-			obj->shapeId = b2CreateCircleShape(obj->bodyId, &shapeDef, &circle);
-		}
 
-		// If the object is static, add a ground and 2 wall sensors to detect
-		// what side of the object we have hit
-		if (obj->type == STATIC || obj->type == KINEMATIC) {
-			b2ShapeDef ground = b2DefaultShapeDef();
-			b2ShapeDef lwall = b2DefaultShapeDef();
-			b2ShapeDef rwall = b2DefaultShapeDef();
-
-			ground.isSensor = lwall.isSensor = rwall.isSensor = true;
-			lwall.userData = rwall.userData = "wall";
-			ground.userData = "ground";
-
-			// This creates a shape that is offset from the center of the main body
-			// That "1" in the b2Rot took me like 2 hours to figure out :(
-			b2Polygon groundPol = b2MakeOffsetBox(size.x * .95, size.y * 0.1, (b2Vec2){0, size.y * .9}, (b2Rot){1, 0});
-			b2Polygon lwallPol = b2MakeOffsetBox(size.x * 0.1, size.y * 0.95, (b2Vec2){-size.x * 0.9, 0}, (b2Rot){1, 0});
-			b2Polygon rwallPol = b2MakeOffsetBox(size.x * 0.1, size.y * 0.1, (b2Vec2){size.x + 0.9, 0}, (b2Rot){1, 0});
-
-			// Add sensors to polygon
-			b2CreatePolygonShape(obj->bodyId, &ground, &groundPol);
-			b2CreatePolygonShape(obj->bodyId, &lwall, &lwallPol);
-			b2CreatePolygonShape(obj->bodyId, &rwall, &rwallPol);
-		} 
+	// Solve on the worker thread pool
+	attachScheduler(&worldDef);
+	data->worldId = b2CreateWorld(&worldDef);
+
+	// Moving bodies can go anywhere, so they always exist, disabled until the streamer finds them in range
+	for (int i = 0; i < data->file.numberOfObjects; i++) {
+		Object* obj = &data->file.objects[i];
+		if (obj->type == DYNAMIC || obj->type == KINEMATIC) createObjectBody(data->worldId, &data->stores, obj);
+	}
+
+	// Static bodies and collectibles are streamed in by chunk, starting around the player
+	const p start = data->file.objects[0].p;
+	buildStreamer(&data->streamer, &data->stores, data->level.levelWidth, data->level.levelHeight, &data->arena);
+	updateStreamer(&data->streamer, data->worldId, &data->stores, data->file.objects, start.x + start.w / 2, start.y + start.h / 2);
+
+	// Every debris body exists from the start, so throwing debris out never creates any
+	// It only hits the level, so it never pushes the player around
+	buildEntityPool(&data->debris, data->worldId, DEBRIS_CAPACITY, DEBRIS_SIZE, CATEGORY_LEVEL, &data->arena);
+
+	// Remember the bodies as they start so a restart doesn't need to rebuild them
+	snapshotBodies(&data->start, &data->stores, &data->arena);
+}
+
+bool buildLevel(const char *path, LevelData *data) {
+	const Uint64 start = SDL_GetTicksNS();
+	const bool loaded = readLevelFile(path, &data->file);
+	if (loaded) {
+		const Uint64 read = SDL_GetTicksNS();
+		setUpLevelInfo(data);
+		connectSDLtoObjects(data);
+
+		const Uint64 stored = SDL_GetTicksNS();
+		initBox2D(data);
+		data->built = true;
+
+		// Kept with the level for the benchmark
+		data->level.fileTime = read - start;
+		data->level.storesTime = stored - read;
+		data->level.box2DTime = SDL_GetTicksNS() - stored;
 	}
+
+	return loaded;
 }
 
-// Handles game inputs, returns a vector of the desired player velocity
-void handleInputs(double elapsed) {
+// Handles SDL events and turns the keyboard state into this step's input flags
+void handleEvents() {
 	// Pump events gets us the next events for the game
 	SDL_PumpEvents();
 	SDL_Event e;
@@ -151,10 +238,27 @@ void handleInputs(double elapsed) {
 	while (SDL_PollEvent(&e) != 0) {
 		// Quit game
 		if (e.type == SDL_EVENT_QUIT) world.level.levelStatus = -1;
+
+		// F3 shows the profiler
+		if (e.type == SDL_EVENT_KEY_DOWN && !e.key.repeat && e.key.scancode == SDL_SCANCODE_F3) toggleProfileOverlay();
+
+		// R restarts the level
+		if (e.type == SDL_EVENT_KEY_DOWN && !e.key.repeat && e.key.scancode == SDL_SCANCODE_R) world.level.levelStatus = 2;
+
+		// Some backends lose what was drawn into render targets, draw the static tiles again
+		if (e.type == SDL_EVENT_RENDER_TARGETS_RESET || e.type == SDL_EVENT_RENDER_DEVICE_RESET) invalidateStaticTiles(&staticTiles);
 	}
 
+	world.input = 0;
+	if (world.keys[SDL_SCANCODE_LEFT]) world.input |= INPUT_LEFT;
+	if (world.keys[SDL_SCANCODE_RIGHT]) world.input |= INPUT_RIGHT;
+	if (world.keys[SDL_SCANCODE_UP]) world.input |= INPUT_UP;
+}
+
+// Handles game inputs, returns a vector of the desired player velocity
+void handleInputs(double elapsed) {
 	// Get player velocity
-	const b2BodyId playerId = objects[0].bodyId; 
+	const b2BodyId playerId = stores.dynamics.bodyId[0]; 
 	b2Vec2 velocity = b2Body_GetLinearVelocity(playerId);
 
 	// Define desired force
@@ -163,19 +267,19 @@ void handleInputs(double elapsed) {
 	// If holding up, and we can jump, then jump
 	// The jump buffer makes it so that we can have a dynamic jump boost based on 
 	// how long you hold up, to a certain fram elimit
-	if (world.keys[SDL_SCANCODE_UP] && (player.canJump || player.jumpBuffer > 0)) {
+	if ((world.input & INPUT_UP) && (player.canJump || player.jumpBuffer > 0)) {
 		player.canJump = false;
 		player.jumpBuffer--;
 		force.y += player.yForce * elapsed;
 	} 
 
 	// Move Left
-	if (world.keys[SDL_SCANCODE_LEFT]) {
+	if (world.input & INPUT_LEFT) {
 		force.x += -player.xForce * elapsed;
 	}
 
 	// Move Right
-	if (world.keys[SDL_SCANCODE_RIGHT]) {
+	if (world.input & INPUT_RIGHT) {
 		force.x += player.xForce * elapsed;
 	}
 
@@ -187,173 +291,373 @@ void handleInputs(double elapsed) {
 	player.desiredVelocity = force;
 }
 
-// Locate collectible object and set draw to false so we don't draw it
-// Return boolean if we succesfully cleared the collectible
-bool clearCollectible(b2ShapeId shapeId) {
-	for(int i = 0; i < world.numberOfObjects; i++) {
-		if (objects[i].shapeId.index1 == shapeId.index1) {
-			// If we already have cleared this object
-			if (objects[i].draw == false) return false;
-
-			objects[i].draw = false;
-			return true;
-		}
+// Throws a fan of debris up out of a collectible
+static void spawnDebrisBurst(SDL_FRect rect, Color color) {
+	const b2Vec2 center = SDLXYToBox2D(rect.x + rect.w / 2, rect.y + rect.h / 2);
+
+	for (int i = 0; i < DEBRIS_BURST; i++) {
+		const float angle = SDL_PI_F * (i + 0.5f) / DEBRIS_BURST;
+		const b2Vec2 velocity = {cosf(angle) * DEBRIS_SPEED, sinf(angle) * DEBRIS_SPEED};
+
+		// Out of debris, the rest of the burst is skipped
+		if (spawnEntity(&debris, center, velocity, color, DEBRIS_LIFETIME) < 0) return;
 	}
-	return false;
 }
 
-b2Vec2 getKinematicVelocity(Object* obj) {
-	// Calculate velocity for kinematic platforms
-	float phase = fmod((SDL_GetTicks() - world.level.starttime) / 1000.0, obj->kinematic.time);
-	float period = obj->kinematic.time / 2.0;
+// Set the collectible's draw to false so we don't draw it
+// Return boolean if we succesfully cleared the collectible
+bool clearCollectible(Object* obj) {
+	bool* draw = &stores.collectibles.draw[obj->slot];
 
-	float xint = pixelToMeter(obj->kinematic.endPos.x - obj->kinematic.startPos.x);
-	float yint = pixelToMeter(obj->kinematic.endPos.y - obj->kinematic.startPos.y);
-	int sign;
+	// If we already have cleared this object
+	if (*draw == false) return false;
 
-	if (phase <= period) {
-		sign = 1;
-	} else {
-		sign = -1;
-	}
+	*draw = false;
 
-	return (b2Vec2){xint / period * sign, -yint / period * sign};
+	// Take its sensor out of the broadphase until its chunk is streamed out or the level restarts
+	const b2BodyId bodyId = stores.collectibles.bodyId[obj->slot];
+	if (B2_IS_NON_NULL(bodyId)) b2Body_Disable(bodyId);
+
+	spawnDebrisBurst(stores.collectibles.rect[obj->slot], stores.collectibles.color[obj->slot]);
+	return true;
+}
+
+// Remembers that a body's drawn rect changed this frame, once per frame
+void markChanged(ObjectStore* store, int slot) {
+	if (store->changedFrame[slot] == snapshotFrame) return;
+	store->changedFrame[slot] = snapshotFrame;
+
+	const int list = snapshotFrame & 1;
+	store->changed[list][store->changedCount[list]++] = slot;
 }
 
+// Works out if the player is standing on or against something from the normals of its contacts
+// Landing lets us jump again, leaving the ground takes the jump away like it used to
+static void updatePlayerContacts(b2BodyId playerId) {
+	b2ContactData contacts[PLAYER_MAX_CONTACTS];
+	const int count = b2Body_GetContactData(playerId, contacts, PLAYER_MAX_CONTACTS);
+
+	bool grounded = false;
+	bool touchingWall = false;
+
+	for (int i = 0; i < count; i++) {
+		const b2ContactData* contact = &contacts[i];
+		if (contact->manifold.pointCount == 0) continue;
+
+		// The normal points from shape A to shape B, turn it to point away from the player
+		const bool playerIsA = B2_ID_EQUALS(b2Shape_GetBody(contact->shapeIdA), playerId);
+		const b2ShapeId otherId = playerIsA ? contact->shapeIdB : contact->shapeIdA;
+		const b2Vec2 normal = playerIsA ? contact->manifold.normal : (b2Vec2){-contact->manifold.normal.x, -contact->manifold.normal.y};
+
+		// Only static objects and platforms count, standing on a box doesn't
+		const Object* other = b2Shape_GetUserData(otherId);
+		if (other == NULL || (other->type != STATIC && other->type != KINEMATIC)) continue;
+
+		if (normal.y < -CONTACT_NORMAL_THRESHOLD) grounded = true;
+		if (fabsf(normal.x) > CONTACT_NORMAL_THRESHOLD) touchingWall = true;
+	}
+
+	// If we land on something, then we can jump again
+	if (grounded && !player.grounded) {
+		player.canJump = true;
+		player.jumpBuffer = player.bufferFrames;
+	}
+
+	// If we leave the ground and we can jump, set it so that we can't jump
+	if (!grounded && player.grounded && player.canJump) {
+		player.canJump = false;
+		player.jumpBuffer = 0;
+	}
+
+	player.grounded = grounded;
+	player.canWallJump = touchingWall;
+}
 
 void handlePhysics() {
-	const b2BodyId playerId = objects[0].bodyId;
+	const b2BodyId playerId = stores.dynamics.bodyId[0];
 
 	// Apply desired force caluclated from handleInputs() to player
 	b2Body_ApplyForceToCenter(playerId, player.desiredVelocity, true);
 
-	// Get the sensor events in the world, i.e., if we hit a ground or wall sensor
+	// Check if we are on the ground or against a wall from the last step's contacts
+	updatePlayerContacts(playerId);
+
+	// Get the sensor events in the world, the only sensors are collectibles
 	b2SensorEvents sensorEvents = b2World_GetSensorEvents(world.worldId);
-	
-	// A bit hacky but for some reason why box 2d starts it says we have hit a bunch
-	// of objects, so this is to give some buffer space between when the game starts
-	// and the player is able to do anything
-	if (SDL_GetTicks() > 500) {
 
-	// Go through all the objects we are collided with
+	// Go through all the collectibles something started touching
 	for (int i = 0; i < sensorEvents.beginCount; i++) {
 		b2SensorBeginTouchEvent* beginTouch = sensorEvents.beginEvents + i;
-		char* sensor = b2Shape_GetUserData(beginTouch->sensorShapeId);
 
-		// If we touch sensor object with tag "ground", then we can jump again
-		if (strcmp(sensor, "ground") == 0) {
-			player.canJump = true;
-			player.jumpBuffer = player.bufferFrames;
-		}
+		// Streamed out bodies can be destroyed before their begin event is read
+		if (!b2Shape_IsValid(beginTouch->sensorShapeId) || !b2Shape_IsValid(beginTouch->visitorShapeId)) continue;
+
+		// Only the player picks collectibles up
+		if (!B2_ID_EQUALS(b2Shape_GetBody(beginTouch->visitorShapeId), playerId)) continue;
+		Object* obj = b2Shape_GetUserData(beginTouch->sensorShapeId);
 
 		// If we touch a collectible
-		if (strcmp(sensor, "collectible") == 0) {
+		if (obj->type == COLLECTIBLE) {
 			// If we have cleared the collectible, reduce count needed
-			if (clearCollectible(beginTouch->sensorShapeId)) {
+			if (clearCollectible(obj)) {
 				world.level.collectiblesNeeded--;
 			}
 		}
 	}
 
-	// Go through all the objects we are leaving be colided with
-	for (int i = 0; i < sensorEvents.endCount; i++) {
-		b2SensorEndTouchEvent* endTouch = sensorEvents.endEvents + i;
-		char* sensor = b2Shape_GetUserData(endTouch->sensorShapeId);
+	// Calculate next position for our kinmatic objects, the ones out of range are parked
+	advancePaths(stores.kinematics.path, stores.kinematics.pathState, stores.kinematics.bodyId, streamer.activePlatforms, streamer.activePlatformCount, TIME_STEP);
+
+	// Debris runs out of time, and the rest blends from where it is now
+	updateEntityPool(&debris, TIME_STEP);
 
-		// If we leave the ground and we can jump, set it so that we can't jump
-		if (strcmp(sensor, "ground") == 0 && player.canJump) {
-			player.canJump = false;
-			player.jumpBuffer = 0;
+	// Step physics simulation
+	profileBegin(PROFILE_STEP);
+	b2World_Step(world.worldId, TIME_STEP, 8);
+	profileEnd(PROFILE_STEP);
+	profileBox2D(world.worldId);
+	world.steps++;
+
+	// Only bodies that moved send an event, everything else is still where it was
+	stores.dynamics.movedCount = 0;
+	stores.kinematics.movedCount = 0;
+
+	const b2BodyEvents bodyEvents = b2World_GetBodyEvents(world.worldId);
+	for (int i = 0; i < bodyEvents.moveCount; i++) {
+		const b2BodyMoveEvent* move = bodyEvents.moveEvents + i;
+		const Object* obj = move->userData;
+		if (obj == NULL) continue;
+
+		// Debris isn't in the stores, it keeps its positions in its pool
+		if (obj->type == POOLED) {
+			moveEntity(&debris, obj->slot, move->transform.p);
+			continue;
 		}
+
+		ObjectStore* store = storeFor(obj->type);
+		if (store->position == NULL) continue;
+
+		store->position[obj->slot] = move->transform.p;
+		store->moved[store->movedCount++] = obj->slot;
+		markChanged(store, obj->slot);
+
+		// Dynamic bodies are streamed by the chunk they are in
+		if (obj->type == DYNAMIC) moveStreamedBody(&streamer, store, obj->slot);
 	}
+
+	// Create and destroy the still bodies around where the player moved to
+	const b2Vec2 playerPosition = stores.dynamics.position[0];
+	const b2Vec2 center = Box2DXYToSDL(playerPosition.x, playerPosition.y);
+	updateStreamer(&streamer, world.worldId, &stores, objects, center.x, center.y);
+}
+
+// Only the bodies that moved in the last step can be somewhere else, asleep ones
+// already have their previous and current positions the same
+static void syncPreviousPositions(ObjectStore* store) {
+	for (int i = 0; i < store->movedCount; i++) {
+		const int slot = store->moved[i];
+		store->previousPosition[slot] = store->position[slot];
 	}
+}
+
+void fixedUpdate() {
+	// Remember where the moving bodies were before this step so render() can blend
+	// between the previous and current positions
+	syncPreviousPositions(&stores.dynamics);
+	syncPreviousPositions(&stores.kinematics);
+
+	// Handle game inputs, calculate desired player velocity
+	// Forces are applied for exactly one step
+	recordInput(world.input);
+
+	profileBegin(PROFILE_INPUTS);
+	handleInputs(TIME_STEP * 1000.0);
+	profileEnd(PROFILE_INPUTS);
 
-	// Calculate next position for our kinmatic objects
-	for (int i = 0; i < world.numberOfObjects; i++) {
-		Object* obj = &objects[i];
+	// Step through physics, apply desired player velocity to player
+	profileBegin(PROFILE_PHYSICS);
+	handlePhysics();
+	profileEnd(PROFILE_PHYSICS);
+}
 
-		if (obj->type != KINEMATIC) continue;
-		b2Vec2 vel = getKinematicVelocity(obj);
-		b2Body_SetLinearVelocity(obj->bodyId, vel);
+// Position of a body between the previous and current physics step
+static b2Vec2 getInterpolatedPosition(const ObjectStore* store, int slot, float alpha) {
+	return b2Lerp(store->previousPosition[slot], store->position[slot], alpha);
+}
+
+// Brings a store's moving objects in a snapshot layer to their interpolated level positions
+// A layer that is one or two frames behind only gets the bodies that changed since, the rest
+// keep the rects they already have. Anything else is filled in full
+static void snapshotLayer(SnapshotLayer* layer, const ObjectStore* store, float alpha, Uint64 framesBehind) {
+	if (framesBehind == 0 || framesBehind > 2) {
+		bodiesToScreen(store->previousPosition, store->position, store->rect, store->count, alpha, 0, 0, layer->rects);
+		memcpy(layer->colors, store->color, sizeof(Color) * store->count);
+		return;
 	}
 
-	// Step physics simulation
-	b2World_Step(world.worldId, 1.0f / 60.0f, 8);
+	const int list = snapshotFrame & 1;
+	bodiesToScreenAt(store->previousPosition, store->position, store->rect, store->changed[list], store->changedCount[list], alpha, 0, 0, layer->rects);
+	if (framesBehind == 2) {
+		bodiesToScreenAt(store->previousPosition, store->position, store->rect, store->changed[!list], store->changedCount[!list], alpha, 0, 0, layer->rects);
+	}
 }
 
+// Starts the next frame's changed list with the bodies still between two steps,
+// they are drawn somewhere else every frame as alpha changes
+static void beginChangedFrame(ObjectStore* store) {
+	store->changedCount[snapshotFrame & 1] = 0;
+	for (int i = 0; i < store->movedCount; i++) markChanged(store, store->moved[i]);
+}
 
-void render(Uint64 startTime) { // Render background
-	SDL_SetRenderDrawColor(world.renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-	SDL_RenderClear(world.renderer);
+void takeFrameSnapshot(FrameSnapshot* snapshot, float alpha) {
+	reserveSnapshot(snapshot, stores.kinematics.count, stores.dynamics.count, debris.count, stores.collectibles.count);
 
 	// Get Camera Offset
-	b2Vec2 playerPosition = b2Body_GetPosition(objects[0].bodyId);
-	b2Vec2 position = box2DToSDL(playerPosition, &objects[0]);
+	b2Vec2 playerPosition = getInterpolatedPosition(&stores.dynamics, 0, alpha);
+	b2Vec2 position = box2DToSDL(playerPosition, &stores.dynamics.rect[0]);
 
 	// Get the x and y offset from the center of the first screen
-	world.xoffset = (float)WIDTH / 2 - position.x;
-	world.yoffset = (float)HEIGHT / 2 - position.y;
+	snapshot->xoffset = (float)WIDTH / 2 - position.x;
+	snapshot->yoffset = (float)HEIGHT / 2 - position.y;
 
 	// If we are on the boundaries of the world, set the world offset to a constand value, i.e., unchanging
-	if (position.x <= world.level.cameraLeftOffset) world.xoffset = 0;
-	if (position.x >= world.level.cameraRightOffset) world.xoffset = WIDTH - world.level.levelWidth;
-	if (position.y <= world.level.cameraBottomOffset) world.yoffset = 0;
-	if (position.y >= world.level.cameraTopOffset) world.yoffset = HEIGHT - world.level.levelHeight;
-
-	// Draw bodies
-	for (int i = 0; i < world.numberOfObjects; i++) {
-		Object* obj = &objects[i];
-
-		// Determine if we should draw the object
-		if (!obj->draw) continue;
-
-		// Get the Box2D object's position as SDL, add offsets to it
-		b2Vec2 position = box2DToSDL(b2Body_GetPosition(obj->bodyId), obj); 
-
-		// Add to our objects position the world offsets
-		obj->rect.x = position.x + world.xoffset;
-		obj->rect.y = position.y + world.yoffset;
-
-		// Draw object shape depending on object type
-		if (obj->type != COLLECTIBLE) {
-			renderRectangle(world.renderer, obj);
-		} else {
-			renderCircle(world.renderer, obj);
-		}
+	if (position.x <= world.level.cameraLeftOffset) snapshot->xoffset = 0;
+	if (position.x >= world.level.cameraRightOffset) snapshot->xoffset = WIDTH - world.level.levelWidth;
+	if (position.y <= world.level.cameraBottomOffset) snapshot->yoffset = 0;
+	if (position.y >= world.level.cameraTopOffset) snapshot->yoffset = HEIGHT - world.level.levelHeight;
+
+	// Snapshots from another level, or never taken, have nothing to keep
+	const Uint64 framesBehind = snapshot->epoch == snapshotEpoch ? snapshotFrame - snapshot->frame : 0;
+	snapshotLayer(&snapshot->kinematics, &stores.kinematics, alpha, framesBehind);
+	snapshotLayer(&snapshot->dynamics, &stores.dynamics, alpha, framesBehind);
+	snapshot->frame = snapshotFrame;
+	snapshot->epoch = snapshotEpoch;
+
+	// Debris comes and goes, so the few live pieces are copied every frame
+	bodiesToScreen(debris.previousPosition, debris.position, debris.rect, debris.count, alpha, 0, 0, snapshot->debris.rects);
+	memcpy(snapshot->debris.colors, debris.color, sizeof(Color) * debris.count);
+
+	snapshotFrame++;
+	beginChangedFrame(&stores.kinematics);
+	beginChangedFrame(&stores.dynamics);
+
+	memcpy(snapshot->collectibleDraw, stores.collectibles.draw, sizeof(bool) * stores.collectibles.count);
+	snapshot->collectiblesNeeded = world.level.collectiblesNeeded;
+}
+
+// Draws the moving objects of a layer, skipping ones out of view
+static void renderLayer(const SnapshotLayer* layer, SDL_FRect view, float xoffset, float yoffset) {
+	for (int i = 0; i < layer->count; i++) {
+		if (!rectsOverlap(layer->rects[i], view)) continue;
+
+		SDL_FRect rect = layer->rects[i];
+		rect.x += xoffset;
+		rect.y += yoffset;
+		renderRectangle(&rect, layer->colors[i]);
+	}
+}
+
+// Static objects and collectibles are read from the level, they only change between frames
+void drawSnapshot(const FrameSnapshot* snapshot) {
+	// Render background
+	SDL_SetRenderDrawColor(world.renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+	SDL_RenderClear(world.renderer);
+
+	// Find what the camera can see, the view is the screen in level pixels
+	const SDL_FRect view = {-snapshot->xoffset, -snapshot->yoffset, WIDTH, HEIGHT};
+
+	// Static objects never move, so copy them from the tiles they were drawn into
+	drawStaticTiles(&staticTiles, world.renderer, &staticCull, &stores.statics, view, snapshot->xoffset, snapshot->yoffset);
+
+	// Moving bodies, the player is drawn over the platforms
+	renderLayer(&snapshot->kinematics, view, snapshot->xoffset, snapshot->yoffset);
+	renderLayer(&snapshot->debris, view, snapshot->xoffset, snapshot->yoffset);
+	renderLayer(&snapshot->dynamics, view, snapshot->xoffset, snapshot->yoffset);
+
+	// Collectibles never move either, only draw the ones not picked up yet
+	const int visibleCollectibles = cullRects(&collectibleCull, stores.collectibles.rect, view);
+	for (int i = 0; i < visibleCollectibles; i++) {
+		const int slot = collectibleCull.visible[i];
+		if (!snapshot->collectibleDraw[slot]) continue;
+
+		SDL_FRect rect = stores.collectibles.rect[slot];
+		rect.x += snapshot->xoffset;
+		rect.y += snapshot->yoffset;
+
+		renderCircle(world.renderer, &rect, stores.collectibles.color[slot]);
 	}
 
+	// Draw everything queued, the rectangles in one batch under the collectibles in another
+	flushRectangles(world.renderer);
+	flushCircles(world.renderer);
+
 	
 	// Render text of how many more collectibles we needed
 	SDL_SetRenderDrawColor(world.renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 	SDL_SetRenderScale(world.renderer, 2.0f, 2.0f);
-	SDL_RenderDebugTextFormat(world.renderer, 10, 10, "Collectibles Needed: %" SDL_PRIu32 "", world.level.collectiblesNeeded); 
-	/*SDL_RenderDebugTextFormat(world.renderer, 10, 30, "Player Position: X: %f %f", position.x, position.y); */
+	SDL_RenderDebugTextFormat(world.renderer, 10, 10, "Collectibles Needed: %" SDL_PRIu32 "", snapshot->collectiblesNeeded); 
 	SDL_SetRenderScale(world.renderer, 1.0f, 1.0f);
 
+	// Stage timings from the last frames, if shown
+	renderProfileOverlay(world.renderer);
+}
+
+void drawFrame(float alpha) {
+	static FrameSnapshot snapshot;
+	takeFrameSnapshot(&snapshot, alpha);
+	drawSnapshot(&snapshot);
+}
+
+static void render(const FrameSnapshot* snapshot) {
+	profileBegin(PROFILE_DRAW);
+	drawSnapshot(snapshot);
+	profileEnd(PROFILE_DRAW);
+
 	// Display To Window
+	profileBegin(PROFILE_PRESENT);
 	SDL_RenderPresent(world.renderer);
+	profileEnd(PROFILE_PRESENT);
 
-	// Wait for frame based on how long we have calculated for
-	const Uint64 elapsedTime = SDL_GetTicks() - startTime;
-	if (elapsedTime < MS_PER_SECOND) SDL_Delay(MS_PER_SECOND - elapsedTime);
-
-	world.lastTime = startTime;
+	// Hold the frame until the next one is due, unless VSync or uncapped
+	profileBegin(PROFILE_WAIT);
+	waitForNextFrame();
+	profileEnd(PROFILE_WAIT);
 }
 
 int gameLoop() {
-	const Uint64 startTime = SDL_GetTicks();
-	const double elapsedTime = startTime - world.lastTime;
+	const Uint64 startTime = SDL_GetTicksNS();
+	double frameTime = (startTime - world.lastTime) / 1e9;
+	world.lastTime = startTime;
+	profileFrameBegin();
 
-	// Handle game inputs, calculate desired player velocity
-	// Take in elapsed Time to apply to force calculations
-	handleInputs(elapsedTime);
+	// After a long stall only catch up a few steps, otherwise the steps we take
+	// to catch up make the next frame even slower
+	if (frameTime > TIME_STEP * MAX_STEPS_PER_FRAME) frameTime = TIME_STEP * MAX_STEPS_PER_FRAME;
+	world.accumulator += frameTime;
 
-	// Step through physics, apply desired player velocity to player
-	handlePhysics();
+	// Read SDL events and the keyboard
+	profileBegin(PROFILE_EVENTS);
+	handleEvents();
+	profileEnd(PROFILE_EVENTS);
 
-	// Convert Box2D positions to SDL, render
-	// Take in startTime to calculate how much to wait for this frame
-	render(startTime);
+	if (world.level.levelStatus == 2) {
+		recordRestart();
+		restartLevel();
+	}
+
+	// Take as many fixed steps as the elapsed time covers, possibly none
+	int steps = 0;
+	while (world.accumulator >= TIME_STEP) {
+		steps++;
+		world.accumulator -= TIME_STEP;
+	}
+
+	// Simulate this frame on the simulation thread while the last one is drawn, both
+	// are done before anything else touches the level. Drawn between the last two steps
+	beginSimulation(steps, world.accumulator / TIME_STEP);
+	render(drawnSnapshot());
+	endSimulation();
+	profileFrameEnd();
 
 	// If we collect all the collectibles, set level status to completed
 	if (world.level.collectiblesNeeded <= 0) world.level.levelStatus = 1;
@@ -363,231 +667,123 @@ int gameLoop() {
 }
 
 // This justs destroys Box2D so we can create a new level
+// The stores and grids' memory is given back with one rewind of the level arena, the world's with b2DestroyWorld()
 void cleanLevel() {
+	if (objects == NULL) return;
+
 	b2DestroyWorld(world.worldId);
-	free(objects);
+	destroyCullIndex(&staticCull);
+	destroyCullIndex(&collectibleCull);
+	destroyObjectStores();
+	arenaReset(&levelArena);
+	closeLevelFile(&levelFile);
+	objects = NULL;
+}
+
+void releaseLevelData(LevelData *data) {
+	if (data->built) {
+		b2DestroyWorld(data->worldId);
+		closeLevelFile(&data->file);
+	}
+
+	Arena arena = data->arena;
+	arenaReset(&arena);
+
+	// Everything but the arena's blocks is forgotten
+	memset(data, 0, sizeof(LevelData));
+	data->arena = arena;
+}
+
+void restartLevel() {
+	// Put the bodies, collectibles and player back without rebuilding the world
+	restoreSnapshot(&levelStart);
+	clearEntityPool(&debris);
+
+	// Coins that were picked up are back, so stream the chunks around the player in again
+	const b2Vec2 playerPosition = b2Body_GetPosition(stores.dynamics.bodyId[0]);
+	const b2Vec2 center = Box2DXYToSDL(playerPosition.x, playerPosition.y);
+	resetStreamer(&streamer, world.worldId, &stores, objects, center.x, center.y);
+
+	// Don't draw the frame from before the restart, or keep any of its rects
+	snapshotEpoch++;
+	refreshSnapshot();
 }
 
 // This cleans up everything
 void cleanUp() {
+	// Let a level being built in the background and the frame being simulated finish first
+	stopLoader();
+	destroyPipeline();
+
 	// Clean up SDL
+	destroyStaticTiles(&staticTiles);
+	destroyRenderCache();
 	SDL_DestroyRenderer(world.renderer);
 	SDL_DestroyWindow(world.window);
-	SDL_Quit();
 	cleanLevel();
-}
-
-void initalizeLevel3Objects() {
-	// Create world, set up level information
-	world.level.levelWidth = WIDTH * 3;
-	world.level.levelHeight = HEIGHT * 2;
- 	world.level.cameraLeftOffset = (float)WIDTH / 2;
-	world.level.cameraRightOffset = world.level.levelWidth - world.level.cameraLeftOffset;
-	world.level.cameraBottomOffset = (float)HEIGHT / 2;
-	world.level.cameraTopOffset = world.level.levelHeight - world.level.cameraBottomOffset;
-	world.level.levelStatus = 0;
-	world.level.collectiblesNeeded = 17;
-	world.numberOfObjects = 38;
-	world.level.starttime = SDL_GetTicks();
-
-	// Allocate space for our object array
-	objects = (Object*)malloc(sizeof(Object) * world.numberOfObjects);
-	if (objects == NULL) {
-		puts("Error! Failed to intialized object array!");
-	}
 
-	// Initalize objects
-
-	objects[0] = (Object){.p = (p){100, 100 + HEIGHT, 50, 50}, .color = (Color){255, 0, 0, 255}, .type = DYNAMIC}; // Player
-	objects[1] = (Object){.p = (p){0,HEIGHT - 20 + HEIGHT, world.level.levelWidth, 20}, .color = (Color){0, 255, 0, 255}, .type = STATIC}; // Ground
-	objects[2] = (Object){.p = (p){200,300 + HEIGHT,200,20}, .color = (Color){0, 255, 255, 255}, .type = STATIC}; // Platform 1
-	objects[3] = (Object){.p = (p){40,400 + HEIGHT,100,20}, .color = (Color){0, 0, 255, 255}, .type = STATIC}; // p2
-	objects[4] = (Object){.p = (p){400,100 + HEIGHT,200,40}, .color = (Color){0, 0, 255, 255}, .type = STATIC}; // p3
-	objects[5] = (Object){.p = (p){400,50 + HEIGHT,50,50}, .color = (Color){255, 20, 255, 255}, .type = DYNAMIC}; // p4
-	objects[6] = (Object){.p = (p){175,190 + HEIGHT,150,20}, .color = (Color){125, 255, 30, 255}, .type = STATIC}; // p5
-	objects[7] = (Object){.p = (p){world.level.levelWidth - 20,0,20,world.level.levelHeight}, .color = (Color){20, 255, 100, 255}, .type = STATIC}; // p6
-	objects[8] = (Object){.p = (p){0,0,20,world.level.levelHeight}, .color = (Color){20, 255, 100, 255}, .type = STATIC}; // p7
-	objects[9] = (Object){.p = (p){2 * WIDTH + 200,450 + HEIGHT,100,10}, .color = (Color){40, 80, 90, 255}, .type = STATIC}; // p9
-	objects[10] = (Object){.p = (p){2 * WIDTH + 400,350 + HEIGHT,40,40}, .color = (Color){40, 80, 90, 255}, .type = STATIC}; // p10
-	objects[11] = (Object){.p = (p){WIDTH * 2,0,10,2 * HEIGHT - 120}, .color = (Color){255, 50, 50, 255}, .type = STATIC}; // Wall Left
-	objects[12] = (Object){.p = (p){WIDTH * 2 + 100,0,10,2 * HEIGHT - 120}, .color = (Color){50, 120, 255, 255}, .type = STATIC}; // Wall Right
-	objects[13] = (Object){.p = (p){300, HEIGHT * 2 - 100, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // collectible 1
-	objects[14] = (Object){.p = (p){400, HEIGHT * 2 - 100, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2
-	/*objects[19] = (Object){.p = (p){WIDTH + 300, HEIGHT + 100, 200, 10}, .color = (Color){255, 255, 255, 255}, .type = KINEMATIC}; // Colletile 2*/
-
-	objects[15] = (Object){.p = (p){275, 225 + HEIGHT, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2
-	objects[16] = (Object){.p = (p){75, 325 + HEIGHT, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2
-	objects[17] = (Object){.p = (p){225, HEIGHT + 125, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2
-	objects[18] = (Object){.p = (p){500, 25 + HEIGHT, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2
-	objects[19] = (Object){.p = (p){400,HEIGHT,50,50}, .color = (Color){255, 20, 255, 255}, .type = DYNAMIC}; // inital box
-	objects[20] = (Object){.p = (p){401,HEIGHT - 50,50,50}, .color = (Color){255, 20, 255, 255}, .type = DYNAMIC}; // inital box
-	objects[21] = (Object){.p = (p){550, HEIGHT + 100, 250, 10}, .color = (Color){255, 255, 255, 255}, .type = KINEMATIC}; // moving platform
-	objects[22] = (Object){.p = (p){WIDTH + 200, HEIGHT + 100, 20, HEIGHT - 20}, .color = (Color){0, 255, 0, 255}, .type = STATIC}; // inner wall
-	objects[23] = (Object){.p = (p){WIDTH + 400, HEIGHT + 100, 20, HEIGHT - 20}, .color = (Color){0, 255, 0, 255}, .type = STATIC}; // inner wall
-	objects[24] = (Object){.p = (p){WIDTH + 275, HEIGHT * 2 - 75, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-
-	objects[25] = (Object){.p = (p){700, 2 * HEIGHT - 120, 10, 100}, .color = (Color){50, 20, 255, 255}, .type = STATIC}; // inner wall
-	objects[26] = (Object){.p = (p){800, 2 * HEIGHT - 120, 10, 100}, .color = (Color){50, 20, 255, 255}, .type = STATIC}; // inner wall
-	objects[27] = (Object){.p = (p){650, 2 * HEIGHT - 140, 220, 20}, .color = (Color){60, 180, 176, 255}, .type = DYNAMIC}; // inner wall
-	objects[28] = (Object){.p = (p){725, 2 * HEIGHT - 75, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-
-	objects[29] = (Object){.p = (p){1120, HEIGHT * 2 - 75, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[30] = (Object){.p = (p){1120, HEIGHT * 2 - 130, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	
-	objects[31] = (Object){.p = (p){2020, 710, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[32] = (Object){.p = (p){1650, 920, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[33] = (Object){.p = (p){1750, 920, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[34] = (Object){.p = (p){2230, 890, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[35] = (Object){.p = (p){2400, 790, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[36] = (Object){.p = (p){2140, 700, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-	objects[37] = (Object){.p = (p){2930, 680, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // inner wall
-
-	objects[21].kinematic.time = 10;
-	objects[21].kinematic.startPos.x = 750;
-	objects[21].kinematic.startPos.y = HEIGHT + 100; 
-	objects[21].kinematic.endPos.x = WIDTH + 350;
-	objects[21].kinematic.endPos.y = HEIGHT + 100; 
-	
-	// Initalize player
-	player.canJump = false;
-	player.maxVelocityX = 10.0f;
-	player.jumpBuffer = 0;
-	player.bufferFrames = 10;
-	player.xForce = 2.0f;
-	player.yForce = 3.0f;
-
-	// Set it so everything is visible
-	for (int i = 0; i < world.numberOfObjects; i++) objects[i].draw = true;
+	// The worker threads and the timers still use SDL, so they go before it does
+	destroyScheduler();
+	destroyProfiler();
+	destroyPacer();
+	destroyArena(&levelArena);
+	stopRecording();
+	SDL_Quit();
 }
 
-void initalizeLevel2Objects() {
-	// Create world, set up level information
-	world.level.levelWidth = WIDTH * 2;
-	world.level.levelHeight = HEIGHT;
- 	world.level.cameraLeftOffset = (float)WIDTH / 2;
-	world.level.cameraRightOffset = world.level.levelWidth - world.level.cameraLeftOffset;
-	world.level.cameraBottomOffset = (float)HEIGHT / 2;
-	world.level.cameraTopOffset = world.level.levelHeight - world.level.cameraBottomOffset;
+void swapLevel(LevelData *data) {
+	const LevelData playing = {
+		.built = objects != NULL,
+		.file = levelFile,
+		.level = world.level,
+		.stores = stores,
+		.staticCull = staticCull,
+		.collectibleCull = collectibleCull,
+		.streamer = streamer,
+		.debris = debris,
+		.worldId = world.worldId,
+		.start = levelStart,
+		.arena = levelArena,
+	};
+
+	levelFile = data->file;
+	objects = levelFile.objects;
+	world.numberOfObjects = levelFile.numberOfObjects;
+	world.worldId = data->worldId;
+	world.level = data->level;
+	stores = data->stores;
+	staticCull = data->staticCull;
+	collectibleCull = data->collectibleCull;
+	streamer = data->streamer;
+	debris = data->debris;
+	levelStart = data->start;
+	levelArena = data->arena;
+
+	*data = playing;
+
+	// The level starts now
 	world.level.levelStatus = 0;
-	world.level.collectiblesNeeded = 9;
-	world.level.starttime = SDL_GetTicks();
-	world.numberOfObjects = 24;
-
-	// Allocate space for our object array
-	objects = (Object*)malloc(sizeof(Object) * world.numberOfObjects);
-	if (objects == NULL) {
-		puts("Error! Failed to intialized object array!");
-	}
 
-	// Initalize objects
-	objects[0] = (Object){.p = (p){100, 100, 50, 50}, .color = (Color){255, 0, 0, 255}, .type = DYNAMIC}; // Player
-	objects[1] = (Object){.p = (p){0, HEIGHT - 20, WIDTH * 2, 20}, .color = (Color){80, 50, 175, 255}, .type = STATIC}; // Ground
-	objects[2] = (Object){.p = (p){0, 0, 20, HEIGHT}, .color = (Color){80, 50, 175, 255}, .type = STATIC}; // Left Wall
-	objects[3] = (Object){.p = (p){WIDTH * 2 - 20, 0, 20, HEIGHT}, .color = (Color){80, 50, 175, 255}, .type = STATIC}; // Right Wall
-
-	objects[4] = (Object){.p = (p){200, 420, 100, 20}, .color = (Color){0, 255, 255, 0}, .type = STATIC}; // Right Wall
-	objects[5] = (Object){.p = (p){20, 150, 50, 10}, .color = (Color){255, 255, 255, 0}, .type = STATIC}; // Right Wall
-	objects[6] = (Object){.p = (p){500, 300, 100, 20}, .color = (Color){0, 255, 0, 0}, .type = STATIC}; // Right Wall
-	objects[7] = (Object){.p = (p){750, 300, 50, 10}, .color = (Color){80, 50, 175, 255}, .type = STATIC}; // Right Wall
-	objects[8] = (Object){.p = (p){1000, 200, 20, 10}, .color = (Color){255, 50, 100, 0}, .type = STATIC}; // Right Wall, 
-	objects[9] = (Object){.p = (p){1200, 300, 20, 280}, .color = (Color){255, 180, 20, 0}, .type = STATIC}; // Right Wall, 
-	objects[10] = (Object){.p = (p){1200, 0, 20, 50}, .color = (Color){255, 180, 20, 0}, .type = STATIC}; // Right Wall, 
-	objects[11] = (Object){.p = (p){1200, 0, 20, 100}, .color = (Color){255, 255, 255, 0}, .type = KINEMATIC}; // Right Wall, 
-
-	objects[12] = (Object){.p = (p){1400, 400, 100, 10}, .color = (Color){255, 0, 0, 255}, .type = STATIC}; // Right Wall, 
-	objects[13] = (Object){.p = (p){1400, 200, 50, 10}, .color = (Color){0, 255, 0, 255}, .type = STATIC}; // Right Wall, 
-	objects[14] = (Object){.p = (p){1700, 100, 100, 20}, .color = (Color){0, 0, 255, 255}, .type = STATIC}; // Right Wall, 
-
-	objects[15] = (Object){.p = (p){230, 360, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[16] = (Object){.p = (p){530, 240, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[17] = (Object){.p = (p){25, 90, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[18] = (Object){.p = (p){765, 240, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[19] = (Object){.p = (p){980, 140, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[20] = (Object){.p = (p){1425, 340, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[21] = (Object){.p = (p){1400, 140, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[22] = (Object){.p = (p){1730, 40, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-	objects[23] = (Object){.p = (p){1915, 40, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall, 
-
-	objects[11].kinematic.time = 5;
-	objects[11].kinematic.startPos.x = 1200;
-	objects[11].kinematic.startPos.y = 0; 
-	objects[11].kinematic.endPos.x = 1200;
-	objects[11].kinematic.endPos.y = 300;
-	
-
-	/*objects[4] = (Object){.p = (p){200, HEIGHT - 200, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2*/
-	/*objects[5] = (Object){.p = (p){300, HEIGHT - 200, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2*/
-	/*objects[6] = (Object){.p = (p){400, HEIGHT - 200, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2*/
-	/*objects[7] = (Object){.p = (p){500, HEIGHT - 200, 50, 50}, .color = (Color){255, 255, 0, 0}, .type = COLLECTIBLE}; // Colletile 2*/
-	
 	// Initalize player
 	player.canJump = false;
+	player.grounded = false;
 	player.maxVelocityX = 10.0f;
 	player.jumpBuffer = 0;
 	player.bufferFrames = 10;
 	player.xForce = 2.0f;
 	player.yForce = 3.0f;
 
-	// Set it so everything is visible
-	for (int i = 0; i < world.numberOfObjects; i++) objects[i].draw = true;
-}
+	// The new level's statics are drawn into tiles as they are first seen
+	if (world.renderer != NULL) initStaticTiles(&staticTiles, world.level.levelWidth, world.level.levelHeight);
 
-void initalizeLevel1Objects() {
-	// Create world, set up level information
-	world.level.levelWidth = WIDTH;
-	world.level.levelHeight = HEIGHT;
- 	world.level.cameraLeftOffset = (float)WIDTH / 2;
-	world.level.cameraRightOffset = world.level.levelWidth - world.level.cameraLeftOffset;
-	world.level.cameraBottomOffset = (float)HEIGHT / 2;
-	world.level.cameraTopOffset = world.level.levelHeight - world.level.cameraBottomOffset;
-	world.level.levelStatus = 0;
-	world.level.collectiblesNeeded = 8;
-	world.level.starttime = SDL_GetTicks();
-	world.numberOfObjects = 17;
-
-	// Allocate space for our object array
-	objects = (Object*)malloc(sizeof(Object) * world.numberOfObjects);
-	if (objects == NULL) {
-		puts("Error! Failed to intialized object array!");
-	}
-
-	// Initalize objects
-	objects[0] = (Object){.p = (p){100, 100, 50, 50}, .color = (Color){255, 0, 0, 255}, .type = DYNAMIC}; // Player
-	objects[1] = (Object){.p = (p){0, HEIGHT - 20, WIDTH, 20}, .color = (Color){175, 50, 80, 255}, .type = STATIC}; // Ground
-	objects[2] = (Object){.p = (p){0, 0, 20, HEIGHT}, .color = (Color){175, 50, 80, 255}, .type = STATIC}; // Left Wall
-	objects[3] = (Object){.p = (p){WIDTH - 20, 0, 20, HEIGHT}, .color = (Color){175, 50, 80, 255}, .type = STATIC}; // Right Wall
-	
-	objects[4] = (Object){.p = (p){700, 400, 200, 10}, .color = (Color){255, 255, 255, 255}, .type = KINEMATIC}; // Right Wall
-
-	objects[5] = (Object){.p = (p){300, 400, 100, 20}, .color = (Color){50, 255, 50, 255}, .type = STATIC}; // Right Wall
-	objects[6] = (Object){.p = (p){300, 300, 100, 20}, .color = (Color){100, 80, 50, 255}, .type = STATIC}; // Right Wall
-	objects[7] = (Object){.p = (p){300, 200, 100, 20}, .color = (Color){124, 200, 176, 255}, .type = STATIC}; // Right Wall
-	objects[8] = (Object){.p = (p){300, 100, 100, 20}, .color = (Color){50, 20, 255, 255}, .type = STATIC}; // Right Wall
-
-	objects[9] = (Object){.p = (p){325, 340, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[10] = (Object){.p = (p){325, 240, 50, 20}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[11] = (Object){.p = (p){325, 140, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[12] = (Object){.p = (p){325, 40, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[13] = (Object){.p = (p){20, 40, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[14] = (Object){.p = (p){550, 30, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[15] = (Object){.p = (p){800, 425, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-	objects[16] = (Object){.p = (p){920, 40, 50, 50}, .color = (Color){255, 255, 0, 255}, .type = COLLECTIBLE}; // Right Wall
-
-	objects[4].kinematic.time = 10;
-	objects[4].kinematic.startPos.x = 700;
-	objects[4].kinematic.startPos.y = 400; 
-	objects[4].kinematic.endPos.x = 500; 
-	objects[4].kinematic.endPos.y = 100; 
-	
-	// Initalize player
-	player.canJump = false;
-	player.maxVelocityX = 10.0f;
-	player.jumpBuffer = 0;
-	player.bufferFrames = 10;
-	player.xForce = 2.0f;
-	player.yForce = 3.0f;
+	// Remember the player and level as they start for restarts
+	snapshotPlayer(&levelStart);
 
-	// Set it so everything is visible
-	for (int i = 0; i < world.numberOfObjects; i++) objects[i].draw = true;
+	// Start the frame clock fresh so the time spent loading isn't simulated
+	world.accumulator = 0;
+	world.lastTime = SDL_GetTicksNS();
 
+	// The next frame drawn is of this level
+	snapshotEpoch++;
+	refreshSnapshot();
 }
@@ -11,20 +11,26 @@
 #include <stdlib.h>
 #include <box2d/box2d.h>
 
-// Initalize the custom objects to manage Box2D and SDL properties
-// for our three levels
-void initalizeLevel1Objects(void);
-void initalizeLevel2Objects(void);
-void initalizeLevel3Objects(void);
-
 // Initalizes the SDL libraries and related elementes
 void initSDL(void);
 
-// Set up Objects with SDL information 
-void connectSDLtoObjects(void);
+// Polls SDL events and samples the keyboard into world.input
+void handleEvents(void);
+
+// Calculates the desired player force from world.input
+// Takes in the elapsed time in milliseconds the force is applied for
+void handleInputs(double elapsed);
+
+// Applies player forces, handles sensors, and steps the Box2D world once
+void handlePhysics(void);
 
-// Initialized the Box2D library, and creates related elements
-void initBox2D(void);
+// Runs one fixed TIME_STEP: remembers body positions for interpolation,
+// then handles inputs and physics
+void fixedUpdate(void);
+
+// Draws the level into world.renderer without presenting it
+// Alpha is how far we are between the last physics step and the next one, from 0 to 1
+void drawFrame(float alpha);
 
 // Main game loop: handles inputs, calculates, and renders
 // Returns 1 if active, 0 or -1 if not
@@ -35,20 +41,48 @@ void cleanUp(void);
 
 // Cleans up just a level
 void cleanLevel(void);
+void restartLevel(void);
 
 const static int WIDTH = 1000;
 const static int HEIGHT = 500;
-const static float MS_PER_SECOND = 16.67; 
 const static float PIXELS_PER_METER = 50.0f;
+const static float TIME_STEP = 1.0f / 60.0f;
+const static int MAX_STEPS_PER_FRAME = 5;
+
+// A contact normal this close to straight down counts as ground, this close to sideways as a wall
+const static float CONTACT_NORMAL_THRESHOLD = 0.7f;
+
+// Contacts on the player looked at each step
+#define PLAYER_MAX_CONTACTS 16
+
+// Debris thrown out when a collectible is picked up, from a pool made with the level
+const static int DEBRIS_CAPACITY = 256;
+const static int DEBRIS_BURST = 12;
+const static float DEBRIS_SIZE = 8.0f;     // Pixels
+const static float DEBRIS_SPEED = 6.0f;    // Meters per second
+const static float DEBRIS_LIFETIME = 0.75f; // Seconds
+
+// Player inputs for a single physics step, stored as a bitmask
+typedef enum InputFlags {
+	INPUT_LEFT = 1 << 0,
+	INPUT_RIGHT = 1 << 1,
+	INPUT_UP = 1 << 2
+} InputFlags;
 
 // Object type for Box2D and Others
 typedef enum ObjectType {
 	STATIC,
 	DYNAMIC,
 	COLLECTIBLE,
-	KINEMATIC
+	KINEMATIC,
+	POOLED // Spawned while playing from an EntityPool (pool.h), never in a level
 } ObjectType;
 
+// Collision categories. Statics, platforms and collectibles keep Box2D's default, the first
+const static uint64_t CATEGORY_LEVEL = 0x1;
+const static uint64_t CATEGORY_DYNAMIC = 0x2; // The player and boxes
+const static uint64_t CATEGORY_POOLED = 0x4;
+
 // Defines information relating to a Game level
 typedef struct Level {
 	float levelWidth;
@@ -57,9 +91,11 @@ typedef struct Level {
 	float cameraRightOffset;
 	float cameraTopOffset;
 	float cameraBottomOffset;
-	int levelStatus;
+	int levelStatus; // 0 playing, 1 cleared, 2 restart asked for, -1 quit
 	int collectiblesNeeded;
-	Uint64 starttime;
+	Uint64 fileTime;   // Nanoseconds spent reading the level file
+	Uint64 storesTime; // Nanoseconds spent filling the object stores and cull grids
+	Uint64 box2DTime;  // Nanoseconds spent in initBox2D()
 } Level;
 
 // Defines information related to the world, with some globals
@@ -69,10 +105,11 @@ typedef struct World {
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	Uint64 lastTime;
-	float xoffset;
+	double accumulator;
 	Level level;
-	float yoffset;
 	int numberOfObjects;
+	Uint8 input;
+	Uint64 steps;
 } World;
 
 // Color struct for rendering objects in SDL
@@ -91,33 +128,41 @@ typedef struct Position {
 	float h;
 } p;
 
-// Defines kinematc information 
+// Most waypoints a kinematic platform's path can have
+#define KINEMATIC_MAX_POINTS 8
+
+// How a platform speeds up and slows down over each segment of its path
+typedef enum Easing {
+	EASE_LINEAR,
+	EASE_SMOOTH
+} Easing;
+
+// Defines kinematic information, as loaded from a level
+// The platform loops through the points in pixels and back to the first, moving by
+// the differences between them from wherever it starts
 typedef struct Kinematic {
-	b2Vec2 pos;
-	b2Vec2 startPos;
-	b2Vec2 endPos;
-	float time;
+	float time; // Seconds for one lap of the path
+	int pointCount;
+	Easing easing;
+	b2Vec2 points[KINEMATIC_MAX_POINTS];
 } Kinematic;
 
-// Defines some generic rectangle object in the world, 
-// Keeps information for Box2D and SDL
+// Defines some generic rectangle object in the world, as it is loaded from a level
+// Only read while setting up; the per frame data lives in the ObjectStores (store.h)
 typedef struct Object {
 	p p;
-	SDL_FRect rect;
-	b2BodyId bodyId;
-	b2ShapeId shapeId;
 	ObjectType type;
-	b2Polygon polygon;
 	Color color;
 	Kinematic kinematic;
-	bool draw;
+	int slot; // Index into the store for this object's type
 } Object;
 
 
 // Defines player information and velocity constraints
 typedef struct Player {
+	bool grounded; // Standing on a static object or platform, from the last step's contacts
 	bool canJump;
-	bool canWallJump;
+	bool canWallJump; // Touching the side of a static object or platform
 	int bufferFrames;
 	int jumpBuffer;
 	float maxVelocityX;
@@ -0,0 +1,343 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_timer.h>
+#include <box2d/box2d.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "headless.h"
+#include "scheduler.h"
+#include "store.h"
+#include "arena.h"
+#include "replay.h"
+#include "loader.h"
+
+extern World world;
+extern Object* objects;
+
+// A run of ticks that hold the same inputs
+typedef struct ScriptStep {
+	int ticks;
+	Uint8 input;
+} ScriptStep;
+
+// Repeating input pattern: run right, jump right, idle, run left, jump left
+static const ScriptStep script[] = {
+	{90, INPUT_RIGHT},
+	{20, INPUT_RIGHT | INPUT_UP},
+	{40, 0},
+	{90, INPUT_LEFT},
+	{20, INPUT_LEFT | INPUT_UP},
+	{40, 0},
+};
+
+// Get the scripted inputs for a tick
+static Uint8 scriptedInput(int tick) {
+	int length = 0;
+	for (size_t i = 0; i < SDL_arraysize(script); i++) length += script[i].ticks;
+
+	tick %= length;
+	for (size_t i = 0; i < SDL_arraysize(script); i++) {
+		if (tick < script[i].ticks) return script[i].input;
+		tick -= script[i].ticks;
+	}
+	return 0;
+}
+
+static int compareUint64(const void *a, const void *b) {
+	const Uint64 x = *(const Uint64*)a;
+	const Uint64 y = *(const Uint64*)b;
+	return (x > y) - (x < y);
+}
+
+static const char* typeName(ObjectType type) {
+	switch (type) {
+		case STATIC: return "static";
+		case DYNAMIC: return "dynamic";
+		case COLLECTIBLE: return "collectible";
+		case KINEMATIC: return "kinematic";
+		case POOLED: return "pooled";
+	}
+	return "unknown";
+}
+
+// Print the position and velocity of everything that can move
+static void printBodyStates(void) {
+	for (int i = 0; i < world.numberOfObjects; i++) {
+		const Object *obj = &objects[i];
+		if (obj->type != DYNAMIC && obj->type != KINEMATIC) continue;
+
+		const b2BodyId bodyId = storeFor(obj->type)->bodyId[obj->slot];
+		const b2Vec2 pos = b2Body_GetPosition(bodyId);
+		const b2Vec2 vel = b2Body_GetLinearVelocity(bodyId);
+		printf("  body %3d %-9s pos (%9.4f, %9.4f) vel (%9.4f, %9.4f)\n", i, typeName(obj->type), pos.x, pos.y, vel.x, vel.y);
+	}
+}
+
+// Step one level for the given ticks, samples must hold ticks entries
+// Returns the achieved ticks/sec, or -1 if the level couldn't be loaded
+// Prints a report if verbose
+static double runLevel(const char *path, int ticks, Uint64 *samples, bool verbose) {
+	const double nsPerCount = 1e9 / SDL_GetPerformanceFrequency();
+
+	// Every level starts from step 0 so its results don't depend on the levels before it
+	world.steps = 0;
+	if (!loadLevel(path)) return -1;
+
+	const int collectibles = world.level.collectiblesNeeded;
+	int clearedTick = -1;
+	Uint64 total = 0;
+
+	for (int t = 0; t < ticks; t++) {
+		world.input = scriptedInput(t);
+		handleInputs(TIME_STEP * 1000.0);
+
+		const Uint64 start = SDL_GetPerformanceCounter();
+		handlePhysics();
+		samples[t] = (SDL_GetPerformanceCounter() - start) * nsPerCount;
+		total += samples[t];
+
+		if (clearedTick < 0 && world.level.collectiblesNeeded <= 0) clearedTick = t;
+	}
+
+	const double ticksPerSecond = ticks / (total / 1e9);
+
+	if (verbose) {
+		qsort(samples, ticks, sizeof(Uint64), compareUint64);
+
+		printf("%s: %d ticks, %d objects, %d workers\n", path, ticks, world.numberOfObjects, getWorkerCount());
+		printf("  ticks/sec %.1f\n", ticksPerSecond);
+		printf("  step p50 %.3f us, p99 %.3f us\n", samples[ticks / 2] / 1e3, samples[(int)(ticks * 0.99)] / 1e3);
+		printf("  collectibles %d/%d, cleared at tick %d\n", collectibles - world.level.collectiblesNeeded, collectibles, clearedTick);
+		printBodyStates();
+	}
+
+	cleanLevel();
+	return ticksPerSecond;
+}
+
+int runHeadless(int ticks, const char **levelPaths, int levelCount) {
+	Uint64 *samples = malloc(sizeof(Uint64) * ticks);
+	if (samples == NULL) {
+		puts("Error! Failed to allocate headless timing samples!");
+		return 1;
+	}
+
+	int status = 0;
+	for (int l = 0; l < levelCount; l++) {
+		if (runLevel(levelPaths[l], ticks, samples, true) < 0) status = 1;
+	}
+
+	free(samples);
+	stopLoader();
+	destroyScheduler();
+	destroyArena(&levelArena);
+	SDL_Quit();
+	return status;
+}
+
+int runHeadlessSweep(int ticks, const char **levelPaths, int levelCount) {
+	static const int workerCounts[] = {1, 2, 4, 8};
+	double rates[levelCount][SDL_arraysize(workerCounts)];
+
+	Uint64 *samples = malloc(sizeof(Uint64) * ticks);
+	if (samples == NULL) {
+		puts("Error! Failed to allocate headless timing samples!");
+		return 1;
+	}
+
+	for (size_t w = 0; w < SDL_arraysize(workerCounts); w++) {
+		destroyScheduler();
+		initScheduler(workerCounts[w]);
+
+		for (int l = 0; l < levelCount; l++) rates[l][w] = runLevel(levelPaths[l], ticks, samples, false);
+	}
+
+	printf("ticks/sec (speedup vs 1 worker), %d ticks per level\n", ticks);
+	printf("%-20s", "level");
+	for (size_t w = 0; w < SDL_arraysize(workerCounts); w++) printf("  %10d workers", workerCounts[w]);
+	printf("\n");
+
+	for (int l = 0; l < levelCount; l++) {
+		printf("%-20s", levelPaths[l]);
+		for (size_t w = 0; w < SDL_arraysize(workerCounts); w++) {
+			printf("  %9.1f (%4.2fx)", rates[l][w], rates[l][w] / rates[l][0]);
+		}
+		printf("\n");
+	}
+
+	free(samples);
+	stopLoader();
+	destroyScheduler();
+	destroyArena(&levelArena);
+	SDL_Quit();
+	return 0;
+}
+
+// Average of a run of timings in microseconds
+static double averageUs(const Uint64 *samples, int count) {
+	Uint64 total = 0;
+	for (int i = 0; i < count; i++) total += samples[i];
+	return count > 0 ? total / 1e3 / count : 0.0;
+}
+
+int runBenchmark(int ticks, const char **levelPaths, int levelCount) {
+	const double nsPerCount = 1e9 / SDL_GetPerformanceFrequency();
+	const int count = ticks > BENCHMARK_FRAMES ? ticks : BENCHMARK_FRAMES;
+
+	Uint64 *samples = malloc(sizeof(Uint64) * count);
+	if (samples == NULL) {
+		puts("Error! Failed to allocate benchmark timing samples!");
+		return 1;
+	}
+
+	// Frames are drawn in memory, so the benchmark doesn't need a window or a GPU
+	SDL_Surface *surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_RGBA32);
+	if (surface != NULL) world.renderer = SDL_CreateSoftwareRenderer(surface);
+	if (world.renderer == NULL) printf("Error! Couldn't create a software renderer, frames won't be timed: %s\n", SDL_GetError());
+
+	printf("%d ticks and %d frames per level, %d workers, times in ms unless noted\n", ticks, BENCHMARK_FRAMES, getWorkerCount());
+	printf("%-32s %9s %9s %9s %9s %9s %11s %11s %11s %11s\n", "level", "objects", "load", "file", "stores", "box2d",
+		"step us", "step p99 us", "draw us", "present us");
+
+	int status = 0;
+	for (int l = 0; l < levelCount; l++) {
+		world.steps = 0;
+
+		const Uint64 loadStart = SDL_GetTicksNS();
+		if (!loadLevel(levelPaths[l])) {
+			status = 1;
+			continue;
+		}
+		const double loadMs = (SDL_GetTicksNS() - loadStart) / 1e6;
+
+		for (int t = 0; t < ticks; t++) {
+			world.input = scriptedInput(t);
+			handleInputs(TIME_STEP * 1000.0);
+
+			const Uint64 start = SDL_GetPerformanceCounter();
+			handlePhysics();
+			samples[t] = (SDL_GetPerformanceCounter() - start) * nsPerCount;
+		}
+
+		const double stepUs = averageUs(samples, ticks);
+		qsort(samples, ticks, sizeof(Uint64), compareUint64);
+		const double stepP99Us = ticks > 0 ? samples[(int)(ticks * 0.99)] / 1e3 : 0.0;
+
+		// Building the frame and handing it to the renderer, then the renderer drawing it
+		double drawUs = 0;
+		double presentUs = 0;
+		if (world.renderer != NULL) {
+			Uint64 presentTotal = 0;
+
+			for (int f = 0; f < BENCHMARK_FRAMES; f++) {
+				Uint64 start = SDL_GetPerformanceCounter();
+				drawFrame(1.0f);
+				samples[f] = (SDL_GetPerformanceCounter() - start) * nsPerCount;
+
+				start = SDL_GetPerformanceCounter();
+				SDL_RenderPresent(world.renderer);
+				presentTotal += (SDL_GetPerformanceCounter() - start) * nsPerCount;
+			}
+
+			drawUs = averageUs(samples, BENCHMARK_FRAMES);
+			presentUs = presentTotal / 1e3 / BENCHMARK_FRAMES;
+		}
+
+		printf("%-32s %9d %9.2f %9.2f %9.2f %9.2f %11.2f %11.2f %11.2f %11.2f\n", levelPaths[l], world.numberOfObjects, loadMs,
+			world.level.fileTime / 1e6, world.level.storesTime / 1e6, world.level.box2DTime / 1e6,
+			stepUs, stepP99Us, drawUs, presentUs);
+		fflush(stdout);
+	}
+
+	free(samples);
+
+	// Tears down the renderer, its textures and the last level
+	cleanUp();
+	if (surface != NULL) SDL_DestroySurface(surface);
+	return status;
+}
+
+// Prints how a level ended in a replay
+static void printReplayLevel(const char *path, int ticks, Uint64 elapsed) {
+	printf("%s: %d ticks in %.3f ms\n", path, ticks, elapsed / 1e6);
+	printf("  collectibles needed %d\n", world.level.collectiblesNeeded);
+	printBodyStates();
+}
+
+int runReplay(const char *path) {
+	Replay replay;
+	if (!readReplay(path, &replay)) return 1;
+
+	// Steps count up through every level like they do in the game
+	world.steps = 0;
+
+	int status = 0;
+	int level = 0;
+	bool playing = false;
+	int levelTicks = 0;
+	Uint64 levelStart = 0;
+	Uint64 totalTicks = 0;
+	const Uint64 start = SDL_GetTicksNS();
+
+	for (int r = 0; r < replay.runCount; r++) {
+		const ReplayRun run = replay.runs[r];
+
+		// Start the next level on its first run
+		if (!playing) {
+			if (level >= replay.levelCount) {
+				puts("Error! Replay has more levels than it names!");
+				status = 1;
+				break;
+			}
+			if (!loadLevel(replay.levelPaths[level])) {
+				status = 1;
+				break;
+			}
+
+			playing = true;
+			levelTicks = 0;
+			levelStart = SDL_GetTicksNS();
+		}
+
+		if (run.code & REPLAY_LEVEL_END) {
+			printReplayLevel(replay.levelPaths[level], levelTicks, SDL_GetTicksNS() - levelStart);
+			cleanLevel();
+			playing = false;
+			level++;
+			continue;
+		}
+
+		if (run.code & REPLAY_RESTART) {
+			restartLevel();
+			continue;
+		}
+
+		// Same fixed steps the game took, as fast as they can run
+		for (int t = 0; t < run.count; t++) {
+			world.input = run.code & REPLAY_INPUT_MASK;
+			handleInputs(TIME_STEP * 1000.0);
+			handlePhysics();
+		}
+		levelTicks += run.count;
+		totalTicks += run.count;
+	}
+
+	// The session was quit part way through a level
+	if (playing) {
+		printReplayLevel(replay.levelPaths[level], levelTicks, SDL_GetTicksNS() - levelStart);
+		cleanLevel();
+	}
+
+	const double seconds = (SDL_GetTicksNS() - start) / 1e9;
+	const double simulated = totalTicks * TIME_STEP;
+	printf("replayed %" SDL_PRIu64 " ticks (%.1f s of play) in %.3f s, %.1fx real time\n",
+		totalTicks, simulated, seconds, seconds > 0 ? simulated / seconds : 0.0);
+
+	freeReplay(&replay);
+	stopLoader();
+	destroyScheduler();
+	destroyArena(&levelArena);
+	SDL_Quit();
+	return status;
+}
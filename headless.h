@@ -0,0 +1,30 @@
+#pragma once
+#include "game.h"
+
+// Number of physics ticks each level is stepped for when none are given
+const static int HEADLESS_DEFAULT_TICKS = 3600;
+
+// Runs every given level without a window: steps handlePhysics() at a fixed TIME_STEP
+// for the given number of ticks from a scripted input stream, then prints
+// ticks/sec, step latency percentiles and the final body states
+// Returns 0 on success
+int runHeadless(int ticks, const char **levelPaths, int levelCount);
+
+// Runs every given level headless at 1, 2, 4 and 8 workers and prints the
+// ticks/sec of each with the speedup over a single worker
+// Returns 0 on success
+int runHeadlessSweep(int ticks, const char **levelPaths, int levelCount);
+
+// Frames drawn per level by runBenchmark()
+const static int BENCHMARK_FRAMES = 120;
+
+// Loads and steps every given level headless, drawing frames into an offscreen software
+// renderer, and prints a table of load, initBox2D, per step physics and frame submission times
+// Returns 0 on success
+int runBenchmark(int ticks, const char **levelPaths, int levelCount);
+
+// Replays a recorded session without a window: loads the levels it names and feeds
+// its inputs through the same fixed steps, as fast as possible, then prints how
+// each level ended and how much faster than real time the replay ran
+// Returns 0 on success
+int runReplay(const char *path);
@@ -0,0 +1,260 @@
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "level.h"
+
+// Clear everything the game fills in at runtime
+static Object blankObject(p pos, Color color, ObjectType type) {
+	Object obj;
+	memset(&obj, 0, sizeof(Object));
+
+	obj.p = pos;
+	obj.color = color;
+	obj.type = type;
+	return obj;
+}
+
+static bool parseType(const char *name, ObjectType *type) {
+	if (strcmp(name, "static") == 0) *type = STATIC;
+	else if (strcmp(name, "dynamic") == 0) *type = DYNAMIC;
+	else if (strcmp(name, "collectible") == 0) *type = COLLECTIBLE;
+	else if (strcmp(name, "kinematic") == 0) *type = KINEMATIC;
+	else return false;
+	return true;
+}
+
+// Whether the objects can be played: a dynamic player first, known types, and paths that fit
+static bool validObjects(const Object *objects, int count) {
+	if (count == 0 || objects[0].type != DYNAMIC) return false;
+
+	for (int i = 0; i < count; i++) {
+		const Object *obj = &objects[i];
+		if (obj->type != STATIC && obj->type != DYNAMIC && obj->type != COLLECTIBLE && obj->type != KINEMATIC) return false;
+
+		const Kinematic *kinematic = &obj->kinematic;
+		if (obj->type == KINEMATIC && (kinematic->pointCount < 0 || kinematic->pointCount > KINEMATIC_MAX_POINTS)) return false;
+		if (obj->type == KINEMATIC && kinematic->easing != EASE_LINEAR && kinematic->easing != EASE_SMOOTH) return false;
+	}
+	return true;
+}
+
+// Whether the level has a size the cull and streaming grids can be built over
+static bool validSize(float width, float height) {
+	return isfinite(width) && isfinite(height) && width > 0 && height > 0;
+}
+
+bool readLevelText(const char *path, LevelFile *file) {
+	FILE *in = fopen(path, "r");
+	if (in == NULL) {
+		fprintf(stderr, "Error! Couldn't open level %s\n", path);
+		return false;
+	}
+
+	memset(file, 0, sizeof(LevelFile));
+	int capacity = 0;
+	int lineNumber = 0;
+	bool haveHeader = false;
+	char line[256];
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		lineNumber++;
+
+		// Strip comments, skip blank lines
+		char *comment = strchr(line, '#');
+		if (comment != NULL) *comment = '\0';
+
+		char name[32];
+		if (sscanf(line, "%31s", name) != 1) continue;
+
+		if (strcmp(name, "level") == 0) {
+			if (sscanf(line, "%*s %f %f %d", &file->levelWidth, &file->levelHeight, &file->collectiblesNeeded) != 3) goto error;
+			haveHeader = true;
+			continue;
+		}
+
+		// Another point on the path of the kinematic platform before it
+		if (strcmp(name, "waypoint") == 0) {
+			if (file->numberOfObjects == 0) goto error;
+
+			Kinematic *kinematic = &file->objects[file->numberOfObjects - 1].kinematic;
+			if (file->objects[file->numberOfObjects - 1].type != KINEMATIC || kinematic->pointCount == KINEMATIC_MAX_POINTS) goto error;
+
+			b2Vec2 *point = &kinematic->points[kinematic->pointCount];
+			if (sscanf(line, "%*s %f %f", &point->x, &point->y) != 2) goto error;
+			kinematic->pointCount++;
+			continue;
+		}
+
+		ObjectType type;
+		if (!parseType(name, &type)) goto error;
+
+		p pos;
+		Color color;
+		Kinematic kinematic = {0};
+		char easing[16] = "linear";
+		int read = sscanf(line, "%*s %f %f %f %f %d %d %d %d %f %f %f %f %f %15s",
+			&pos.x, &pos.y, &pos.w, &pos.h, &color.r, &color.g, &color.b, &color.a,
+			&kinematic.time, &kinematic.points[0].x, &kinematic.points[0].y, &kinematic.points[1].x, &kinematic.points[1].y, easing);
+
+		if (type == KINEMATIC ? read < 13 : read != 8) goto error;
+
+		if (type == KINEMATIC) {
+			kinematic.pointCount = 2;
+			if (strcmp(easing, "smooth") == 0) kinematic.easing = EASE_SMOOTH;
+			else if (strcmp(easing, "linear") != 0) goto error;
+		}
+
+		if (file->numberOfObjects == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			Object *grown = realloc(file->objects, sizeof(Object) * capacity);
+			if (grown == NULL) goto error;
+			file->objects = grown;
+		}
+
+		Object *obj = &file->objects[file->numberOfObjects++];
+		*obj = blankObject(pos, color, type);
+		obj->kinematic = kinematic;
+	}
+
+	fclose(in);
+
+	if (!haveHeader || !validObjects(file->objects, file->numberOfObjects)) {
+		fprintf(stderr, "Error! Level %s needs a level line and a dynamic player first\n", path);
+		closeLevelFile(file);
+		return false;
+	}
+
+	if (!validSize(file->levelWidth, file->levelHeight)) {
+		fprintf(stderr, "Error! Level %s needs a positive width and height\n", path);
+		closeLevelFile(file);
+		return false;
+	}
+	return true;
+
+error:
+	fprintf(stderr, "Error! Bad level entry at %s:%d\n", path, lineNumber);
+	fclose(in);
+	closeLevelFile(file);
+	return false;
+}
+
+bool mapLevelBinary(const char *path, LevelFile *file) {
+	memset(file, 0, sizeof(LevelFile));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error! Couldn't open level %s\n", path);
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(LevelHeader)) {
+		fprintf(stderr, "Error! Level %s is too small\n", path);
+		close(fd);
+		return false;
+	}
+
+	// Private writable mapping: the game writes each object's store slot,
+	// only the pages it touches get copied, the file itself is never changed
+	void *mapping = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		fprintf(stderr, "Error! Couldn't map level %s\n", path);
+		return false;
+	}
+
+	const LevelHeader *header = mapping;
+	const Object *objects = (const Object*)((char*)mapping + sizeof(LevelHeader));
+	const size_t expected = sizeof(LevelHeader) + (size_t)header->numberOfObjects * sizeof(Object);
+
+	// The objects are used in place, so the file must match this build's Object layout
+	if (memcmp(header->magic, LEVEL_MAGIC, 4) != 0 || header->version != LEVEL_VERSION ||
+		header->objectSize != sizeof(Object) || (size_t)info.st_size != expected || header->numberOfObjects == 0) {
+		fprintf(stderr, "Error! Level %s is not a level for this build, convert it again\n", path);
+		munmap(mapping, info.st_size);
+		return false;
+	}
+
+	// The header can be right and the objects still be corrupt, check them like a text level
+	if (!validObjects(objects, header->numberOfObjects)) {
+		fprintf(stderr, "Error! Level %s needs a dynamic player first and valid objects\n", path);
+		munmap(mapping, info.st_size);
+		return false;
+	}
+
+	if (!validSize(header->levelWidth, header->levelHeight)) {
+		fprintf(stderr, "Error! Level %s needs a positive width and height\n", path);
+		munmap(mapping, info.st_size);
+		return false;
+	}
+
+	file->levelWidth = header->levelWidth;
+	file->levelHeight = header->levelHeight;
+	file->collectiblesNeeded = header->collectiblesNeeded;
+	file->numberOfObjects = header->numberOfObjects;
+	file->objects = (Object*)objects;
+	file->mapping = mapping;
+	file->mappingSize = info.st_size;
+	return true;
+}
+
+bool readLevelFile(const char *path, LevelFile *file) {
+	const char *extension = strrchr(path, '.');
+
+	if (extension != NULL && strcmp(extension, ".lvl") == 0) return mapLevelBinary(path, file);
+	return readLevelText(path, file);
+}
+
+bool writeLevelBinary(const char *path, const LevelFile *file) {
+	FILE *out = fopen(path, "wb");
+	if (out == NULL) {
+		fprintf(stderr, "Error! Couldn't write level %s\n", path);
+		return false;
+	}
+
+	LevelHeader header;
+	memset(&header, 0, sizeof(LevelHeader));
+	memcpy(header.magic, LEVEL_MAGIC, 4);
+	header.version = LEVEL_VERSION;
+	header.objectSize = sizeof(Object);
+	header.numberOfObjects = file->numberOfObjects;
+	header.levelWidth = file->levelWidth;
+	header.levelHeight = file->levelHeight;
+	header.collectiblesNeeded = file->collectiblesNeeded;
+
+	bool ok = fwrite(&header, sizeof(LevelHeader), 1, out) == 1;
+
+	// Write objects in their load state so the game can use them without touching each one
+	for (int i = 0; ok && i < file->numberOfObjects; i++) {
+		const Object *src = &file->objects[i];
+		Object obj = blankObject(src->p, src->color, src->type);
+		obj.kinematic = src->kinematic;
+
+		ok = fwrite(&obj, sizeof(Object), 1, out) == 1;
+	}
+
+	if (fclose(out) != 0) ok = false;
+	if (!ok) fprintf(stderr, "Error! Failed writing level %s\n", path);
+	return ok;
+}
+
+void closeLevelFile(LevelFile *file) {
+	if (file->mapping != NULL) {
+		munmap(file->mapping, file->mappingSize);
+	} else {
+		free(file->objects);
+	}
+
+	file->objects = NULL;
+	file->mapping = NULL;
+	file->mappingSize = 0;
+	file->numberOfObjects = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <stddef.h>
+#include "game.h"
+
+// Levels are authored as text (.txt) and shipped as binary (.lvl)
+//
+// Text format, one entry per line, '#' starts a comment:
+//   level <width> <height> <collectibles needed>
+//   <type> <x> <y> <w> <h> <r> <g> <b> <a> [<time> <start x> <start y> <end x> <end y> [linear|smooth]]
+//   waypoint <x> <y>
+// where type is static, dynamic, collectible or kinematic, and only kinematic
+// objects take the trailing motion values. The first object is the player.
+// A kinematic platform loops from start to end and back over time seconds, each
+// waypoint line after it adds another point to the loop, up to KINEMATIC_MAX_POINTS
+//
+// The binary format is a LevelHeader followed directly by the Object array,
+// so it can be memory mapped and used in place
+
+#define LEVEL_MAGIC "SBLV"
+const static Uint32 LEVEL_VERSION = 2;
+
+// Header of a binary level file, padded so the objects after it stay aligned
+typedef struct LevelHeader {
+	char magic[4];
+	Uint32 version;
+	Uint32 objectSize;
+	Uint32 numberOfObjects;
+	float levelWidth;
+	float levelHeight;
+	Sint32 collectiblesNeeded;
+	Uint32 reserved[9];
+} LevelHeader;
+
+// A level loaded from disk
+typedef struct LevelFile {
+	float levelWidth;
+	float levelHeight;
+	int collectiblesNeeded;
+	int numberOfObjects;
+	Object *objects;
+	void *mapping; // Start of the mapped file, NULL if objects were allocated
+	size_t mappingSize;
+} LevelFile;
+
+// Parses a text level, allocating its objects
+bool readLevelText(const char *path, LevelFile *file);
+
+// Memory maps a binary level, the objects point straight into the mapping
+bool mapLevelBinary(const char *path, LevelFile *file);
+
+// Loads either format, picked by the .lvl extension
+bool readLevelFile(const char *path, LevelFile *file);
+
+// Writes a level in the binary format
+bool writeLevelBinary(const char *path, const LevelFile *file);
+
+// Releases a level's objects, unmapping or freeing them
+void closeLevelFile(LevelFile *file);
@@ -0,0 +1,18 @@
+#include <stdio.h>
+#include "level.h"
+
+// Converts a text level into the binary format the game memory maps
+// Usage: levelconv <in.txt> <out.lvl>
+int main(int argc, char *argv[]) {
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s <in.txt> <out.lvl>\n", argv[0]);
+		return 1;
+	}
+
+	LevelFile file;
+	if (!readLevelText(argv[1], &file)) return 1;
+
+	const bool ok = writeLevelBinary(argv[2], &file);
+	closeLevelFile(&file);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "level.h"
+
+// Every generated object gets its own cell of the level to sit in
+const static float CELL_WIDTH = 200.0f;
+const static float CELL_HEIGHT = 150.0f;
+
+// Cells are laid out this many times wider than tall, levels scroll sideways
+const static int CELL_ASPECT = 8;
+
+// Empty strip along the floor the player starts in
+const static float RUNWAY_HEIGHT = 150.0f;
+const static float WALL_SIZE = 20.0f;
+
+// Small xorshift so the same seed always makes the same level
+static Uint32 randomState = 1;
+
+static Uint32 nextRandom(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+// Random whole number from 0 up to but not including limit
+static int randomBelow(int limit) {
+	return nextRandom() % limit;
+}
+
+static Object makeObject(ObjectType type, float x, float y, float w, float h, Color color) {
+	Object obj;
+	memset(&obj, 0, sizeof(Object));
+
+	obj.type = type;
+	obj.p = (p){x, y, w, h};
+	obj.color = color;
+	return obj;
+}
+
+// Fills the cell with its top left corner at (x, y) with one object of the given type
+static Object makeCellObject(ObjectType type, float x, float y) {
+	const int shade = randomBelow(60);
+
+	switch (type) {
+		case STATIC:
+			// Platform along the bottom of the cell to stand on
+			return makeObject(STATIC, x + randomBelow(60), y + CELL_HEIGHT - 40, 120, 20, (Color){175 - shade, 50, 80 + shade, 255});
+
+		case DYNAMIC:
+			// Box dropped from the top of the cell
+			return makeObject(DYNAMIC, x + 20 + randomBelow(120), y + 20, 30, 30, (Color){60, 120 + shade, 200, 255});
+
+		case KINEMATIC: {
+			// Platform sliding back and forth across the cell
+			Object obj = makeObject(KINEMATIC, x + 10, y + CELL_HEIGHT - 30, 100, 10, (Color){255, 255, 255, 255});
+			obj.kinematic.time = 4 + randomBelow(5);
+			obj.kinematic.pointCount = 2;
+			obj.kinematic.points[0] = (b2Vec2){obj.p.x, obj.p.y};
+			obj.kinematic.points[1] = (b2Vec2){obj.p.x + 80, obj.p.y};
+			return obj;
+		}
+
+		case COLLECTIBLE:
+			return makeObject(COLLECTIBLE, x + 20 + randomBelow(130), y + 50, 30, 30, (Color){255, 255, 0, 255});
+
+		case POOLED:
+			break;
+	}
+	return makeObject(type, x, y, 0, 0, (Color){0, 0, 0, 0});
+}
+
+// Writes a stress test level with the given number of each object type, all laid out on a grid
+// Usage: levelgen <out.lvl> <statics> <dynamics> <kinematics> <collectibles> [seed]
+int main(int argc, char *argv[]) {
+	if (argc != 6 && argc != 7) {
+		fprintf(stderr, "Usage: %s <out.lvl> <statics> <dynamics> <kinematics> <collectibles> [seed]\n", argv[0]);
+		return 1;
+	}
+
+	const int counts[] = {
+		[STATIC] = atoi(argv[2]),
+		[DYNAMIC] = atoi(argv[3]),
+		[KINEMATIC] = atoi(argv[4]),
+		[COLLECTIBLE] = atoi(argv[5]),
+	};
+	if (argc == 7 && atoi(argv[6]) != 0) randomState = atoi(argv[6]);
+
+	int cells = 0;
+	for (size_t t = 0; t < sizeof(counts) / sizeof(counts[0]); t++) {
+		if (counts[t] < 0) {
+			fprintf(stderr, "Error! Object counts can't be negative\n");
+			return 1;
+		}
+		cells += counts[t];
+	}
+
+	// Pick which cell gets which type, shuffled so every part of the level has a mix
+	Uint8 *types = malloc(cells > 0 ? cells : 1);
+	Object *objects = malloc(sizeof(Object) * (cells + 4));
+	if (types == NULL || objects == NULL) {
+		fprintf(stderr, "Error! Failed to allocate %d objects\n", cells);
+		return 1;
+	}
+
+	int filled = 0;
+	for (size_t t = 0; t < sizeof(counts) / sizeof(counts[0]); t++) {
+		for (int i = 0; i < counts[t]; i++) types[filled++] = t;
+	}
+	for (int i = cells - 1; i > 0; i--) {
+		const int j = randomBelow(i + 1);
+		const Uint8 swap = types[i];
+		types[i] = types[j];
+		types[j] = swap;
+	}
+
+	int columns = ceilf(sqrtf((float)cells * CELL_ASPECT));
+	if (columns < 5) columns = 5;
+	const int rows = (cells + columns - 1) / columns;
+
+	LevelFile file;
+	memset(&file, 0, sizeof(LevelFile));
+	file.levelWidth = columns * CELL_WIDTH + WALL_SIZE * 2;
+	file.levelHeight = rows * CELL_HEIGHT + RUNWAY_HEIGHT + WALL_SIZE;
+	file.collectiblesNeeded = counts[COLLECTIBLE];
+	file.objects = objects;
+
+	// Player first, on the runway, then the floor and walls around everything
+	const Color wall = {175, 50, 80, 255};
+	objects[file.numberOfObjects++] = makeObject(DYNAMIC, WALL_SIZE * 2, file.levelHeight - WALL_SIZE - 60, 50, 50, (Color){255, 0, 0, 255});
+	objects[file.numberOfObjects++] = makeObject(STATIC, 0, file.levelHeight - WALL_SIZE, file.levelWidth, WALL_SIZE, wall);
+	objects[file.numberOfObjects++] = makeObject(STATIC, 0, 0, WALL_SIZE, file.levelHeight, wall);
+	objects[file.numberOfObjects++] = makeObject(STATIC, file.levelWidth - WALL_SIZE, 0, WALL_SIZE, file.levelHeight, wall);
+
+	for (int i = 0; i < cells; i++) {
+		const float x = WALL_SIZE + (i % columns) * CELL_WIDTH;
+		const float y = (i / columns) * CELL_HEIGHT;
+		objects[file.numberOfObjects++] = makeCellObject(types[i], x, y);
+	}
+
+	const bool ok = writeLevelBinary(argv[1], &file);
+	if (ok) printf("%s: %d objects, %.0f x %.0f pixels\n", argv[1], file.numberOfObjects, file.levelWidth, file.levelHeight);
+
+	free(types);
+	free(objects);
+	return ok ? 0 : 1;
+}
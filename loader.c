@@ -0,0 +1,63 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_thread.h>
+#include <string.h>
+
+#include "game.h"
+#include "loader.h"
+
+// The level being built, and after a swap the level that was played before it
+static LevelData loading;
+static const char *loadingPath = NULL;
+static bool loaded = false;
+static SDL_Thread *loaderThread = NULL;
+
+static int loadLevelThread(void *data) {
+	(void)data;
+
+	// Release the last level swapped out first, its arena is reused for this one
+	releaseLevelData(&loading);
+	loaded = buildLevel(loadingPath, &loading);
+	return 0;
+}
+
+static void waitForLoader(void) {
+	if (loaderThread == NULL) return;
+
+	SDL_WaitThread(loaderThread, NULL);
+	loaderThread = NULL;
+}
+
+void startLoadingLevel(const char *path) {
+	// Only one level is built at a time
+	waitForLoader();
+
+	loadingPath = path;
+	loaderThread = SDL_CreateThread(loadLevelThread, "loader", NULL);
+
+	// Still load the level, just without hiding the time it takes
+	if (loaderThread == NULL) {
+		SDL_Log("Couldn't create loader thread: %s", SDL_GetError());
+		loadLevelThread(NULL);
+	}
+}
+
+bool finishLoadingLevel(void) {
+	waitForLoader();
+	if (!loaded) return false;
+
+	loaded = false;
+	swapLevel(&loading);
+	return true;
+}
+
+bool loadLevel(const char *path) {
+	startLoadingLevel(path);
+	return finishLoadingLevel();
+}
+
+void stopLoader(void) {
+	waitForLoader();
+	loaded = false;
+	releaseLevelData(&loading);
+	destroyArena(&loading.arena);
+}
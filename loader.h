@@ -0,0 +1,49 @@
+#pragma once
+#include "game.h"
+#include "level.h"
+#include "store.h"
+#include "cull.h"
+#include "snapshot.h"
+#include "arena.h"
+#include "stream.h"
+#include "pool.h"
+
+// Everything built for one level, so the next level can be built while one is played
+typedef struct LevelData {
+	bool built;
+	LevelFile file;
+	Level level;
+	ObjectStores stores;
+	CullIndex staticCull;
+	CullIndex collectibleCull;
+	Streamer streamer;
+	EntityPool debris;
+	b2WorldId worldId;
+	LevelSnapshot start;
+	Arena arena; // Owns the stores, grids and snapshot, the world has Box2D's own allocator
+} LevelData;
+
+// Loads a level file (text or binary) and builds its objects and Box2D world, then starts
+// playing it. Blocks until it is built, returns false if it couldn't be loaded
+bool loadLevel(const char *path);
+
+// Starts building a level on the loader thread while the current level keeps playing
+void startLoadingLevel(const char *path);
+
+// Waits for the level started by startLoadingLevel() and swaps it in for the level
+// being played, the old level is released on the loader thread with the next load
+// Returns false if the level couldn't be loaded
+bool finishLoadingLevel(void);
+
+// Waits for the loader thread and releases the level it holds
+void stopLoader(void);
+
+// Reads a level file and builds everything for it into data, safe to call off the main thread
+// while another level is played. Returns false if the file couldn't be read
+bool buildLevel(const char *path, LevelData *data);
+
+// Makes data the level being played and hands the level that was being played back in data
+void swapLevel(LevelData *data);
+
+// Destroys a built level's world and file, keeping its arena's blocks for the next build
+void releaseLevelData(LevelData *data);
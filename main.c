@@ -1,38 +1,124 @@
+#include <string.h>
 #include "game.h" 
+#include "headless.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "arena.h"
+#include "replay.h"
+#include "loader.h"
+#include "pacer.h"
+#include "pipeline.h"
 
-int main() {
+extern World world;
+
+// Levels played when none are given on the command line
+static const char *defaultLevels[] = {
+	"levels/level1.lvl",
+	"levels/level2.lvl",
+	"levels/level3.lvl",
+};
+
+int main(int argc, char *argv[]) {
 	int levelStatus;
+	const char **levelPaths = defaultLevels;
+	int levelCount = SDL_arraysize(defaultLevels);
+	const char *levelArgs[argc];
+	int levelArgCount = 0;
+	int headlessTicks = 0;
+	int benchTicks = 0;
+	int workers = defaultWorkerCount();
+	bool sweep = false;
+	const char *tracePath = NULL;
+	const char *recordPath = NULL;
+	const char *replayPath = NULL;
+	PaceMode paceMode = PACE_TIMED;
+	double frameRate = PACER_DEFAULT_RATE;
+	const char *frameStatsPath = NULL;
 
-	initSDL(); 
-	initalizeLevel1Objects(); 
-	connectSDLtoObjects();
-	initBox2D(); 
-
-	// Loop until we quit or level is cleared
-	while ((levelStatus = gameLoop()) == 0);
-	if (levelStatus == -1) {
-		cleanUp();
-		return 0;
+	// ./game [--workers N] [--headless [ticks]] [--bench [ticks]] [--sweep] [--trace file]
+	//        [--fps N | --vsync | --uncapped] [--frame-stats file] [--record file | --replay file] [level files...]
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--headless") == 0) {
+			// Run the levels without a window, as fast as possible
+			headlessTicks = HEADLESS_DEFAULT_TICKS;
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0) headlessTicks = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--bench") == 0) {
+			// Time loading, stepping and drawing each level
+			benchTicks = HEADLESS_DEFAULT_TICKS;
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0) benchTicks = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+			// Threads Box2D solves on, including the main thread
+			workers = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--sweep") == 0) {
+			// Compare headless timing at 1, 2, 4 and 8 workers
+			sweep = true;
+		} else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			// Write the profiler's last frames as Chrome trace JSON on exit
+			tracePath = argv[++i];
+		} else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			// Frames per second to pace to
+			paceMode = PACE_TIMED;
+			frameRate = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--vsync") == 0) {
+			// Pace to the display instead
+			paceMode = PACE_VSYNC;
+		} else if (strcmp(argv[i], "--uncapped") == 0) {
+			// Draw frames as fast as they can be made
+			paceMode = PACE_UNCAPPED;
+		} else if (strcmp(argv[i], "--frame-stats") == 0 && i + 1 < argc) {
+			// Write a histogram of frame times on exit
+			frameStatsPath = argv[++i];
+		} else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			// Save every step's inputs so the session can be replayed
+			recordPath = argv[++i];
+		} else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			// Play back a recorded session without a window
+			replayPath = argv[++i];
+		} else {
+			// Anything else is a level to play, in order
+			levelArgs[levelArgCount++] = argv[i];
+		}
 	}
 
-	cleanLevel();
-	initalizeLevel2Objects();
-	connectSDLtoObjects();
-	initBox2D(); 
-
-	while ((levelStatus = gameLoop()) == 0);
-	if (levelStatus == -1) {
-		cleanUp();
-		return 0;
+	if (levelArgCount > 0) {
+		levelPaths = levelArgs;
+		levelCount = levelArgCount;
 	}
 
-	cleanLevel();
-	initalizeLevel3Objects();
-	connectSDLtoObjects();
-	initBox2D(); 
+	initScheduler(workers);
+
+	if (sweep) return runHeadlessSweep(headlessTicks > 0 ? headlessTicks : HEADLESS_DEFAULT_TICKS, levelPaths, levelCount);
+	if (replayPath != NULL) return runReplay(replayPath);
+	if (benchTicks > 0) return runBenchmark(benchTicks, levelPaths, levelCount);
+	if (headlessTicks > 0) return runHeadless(headlessTicks, levelPaths, levelCount);
+
+	initSDL(); 
+	initProfiler(tracePath);
+	initPacer(world.renderer, paceMode, frameRate, frameStatsPath);
+	initPipeline();
+
+	// From here on the threads and files started above are stopped by cleanUp(), even on failure
+	int status = 1;
+	if (recordPath != NULL && !startRecording(recordPath, levelPaths, levelCount)) goto quit;
+
+	if (!loadLevel(levelPaths[0])) goto quit;
 
-	while ((levelStatus = gameLoop()) == 0);
+	// Play each level in order until one is quit
+	for (int l = 0; l < levelCount; l++) {
+		// Build the next level in the background while this one is played
+		if (l + 1 < levelCount) startLoadingLevel(levelPaths[l + 1]);
+
+		// Loop until we quit or level is cleared
+		while ((levelStatus = gameLoop()) == 0);
+		if (levelStatus == 1) recordLevelEnd();
+		if (levelStatus == -1 || l == levelCount - 1) break;
+
+		// Swap the next level in, the cleared one is released on the loader thread
+		if (!finishLoadingLevel()) goto quit;
+	}
+	status = 0;
 
+quit:
 	cleanUp();
-	return 0;
+	return status;
 }
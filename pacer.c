@@ -0,0 +1,150 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pacer.h"
+
+// Sleeps can't be trusted to wake up on time, the pacer starts out spinning this long
+// and then learns how late this machine's sleeps run
+const static Uint64 INITIAL_SPIN_NS = 2000000;
+const static Uint64 MIN_SPIN_NS = 200000;
+const static Uint64 MAX_SPIN_NS = 4000000;
+
+typedef struct Pacer {
+	PaceMode mode;
+	Uint64 period;    // Nanoseconds between frames for PACE_TIMED
+	Uint64 deadline;  // When the next frame is due
+	Uint64 spin;      // How long before the deadline to stop sleeping and spin
+	Uint64 lastFrame; // When the last frame was handed on
+	const char *statsPath;
+
+	// Frame to frame times
+	Uint64 histogram[PACER_BUCKETS];
+	Uint64 frames;
+	Uint64 total;
+	Uint64 shortest;
+	Uint64 longest;
+	Uint64 late; // Frames over one and a half periods, a whole frame shown twice
+} Pacer;
+
+static Pacer pacer = {
+	.mode = PACE_UNCAPPED,
+	.spin = INITIAL_SPIN_NS,
+};
+
+void initPacer(SDL_Renderer *renderer, PaceMode mode, double rate, const char *statsPath) {
+	if (rate <= 0) rate = PACER_DEFAULT_RATE;
+
+	// With VSync frames come at the display's rate, late frames are judged against it
+	if (mode == PACE_VSYNC) {
+		const SDL_DisplayMode *display = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(SDL_GetRenderWindow(renderer)));
+		if (display != NULL && display->refresh_rate > 0) rate = display->refresh_rate;
+	}
+
+	memset(&pacer, 0, sizeof(Pacer));
+	pacer.mode = mode;
+	pacer.period = mode == PACE_UNCAPPED ? 0 : SDL_NS_PER_SECOND / rate;
+	pacer.spin = INITIAL_SPIN_NS;
+	pacer.shortest = SDL_MAX_UINT64;
+	pacer.statsPath = statsPath;
+
+	if (!SDL_SetRenderVSync(renderer, mode == PACE_VSYNC ? 1 : SDL_RENDERER_VSYNC_DISABLED)) {
+		SDL_Log("Couldn't set VSync, frames are timed instead: %s", SDL_GetError());
+		if (mode == PACE_VSYNC) pacer.mode = PACE_TIMED;
+	}
+}
+
+void destroyPacer(void) {
+	if (pacer.statsPath != NULL) writeFrameStats(pacer.statsPath);
+	pacer.statsPath = NULL;
+}
+
+// Sleeps most of the way to the deadline and spins the rest on the nanosecond clock
+static void waitUntil(Uint64 deadline) {
+	Uint64 now = SDL_GetTicksNS();
+
+	if (now + pacer.spin < deadline) {
+		const Uint64 wake = deadline - pacer.spin;
+		SDL_DelayNS(wake - now);
+		now = SDL_GetTicksNS();
+
+		// Spin longer next time if the sleep overran, and slowly give it back if it didn't
+		const Uint64 overrun = now > wake ? now - wake : 0;
+		if (overrun * 2 > pacer.spin) pacer.spin = overrun * 2;
+		else pacer.spin -= pacer.spin / 64;
+
+		if (pacer.spin < MIN_SPIN_NS) pacer.spin = MIN_SPIN_NS;
+		if (pacer.spin > MAX_SPIN_NS) pacer.spin = MAX_SPIN_NS;
+	}
+
+	while (now < deadline) {
+		SDL_CPUPauseInstruction();
+		now = SDL_GetTicksNS();
+	}
+}
+
+static void recordFrame(Uint64 now) {
+	if (pacer.lastFrame == 0) {
+		pacer.lastFrame = now;
+		return;
+	}
+
+	const Uint64 elapsed = now - pacer.lastFrame;
+	pacer.lastFrame = now;
+
+	Uint64 bucket = elapsed / 1000 / PACER_BUCKET_US;
+	if (bucket >= PACER_BUCKETS) bucket = PACER_BUCKETS - 1;
+	pacer.histogram[bucket]++;
+
+	pacer.frames++;
+	pacer.total += elapsed;
+	if (elapsed < pacer.shortest) pacer.shortest = elapsed;
+	if (elapsed > pacer.longest) pacer.longest = elapsed;
+	if (pacer.period > 0 && elapsed * 2 > pacer.period * 3) pacer.late++;
+}
+
+void waitForNextFrame(void) {
+	if (pacer.mode == PACE_TIMED) {
+		const Uint64 now = SDL_GetTicksNS();
+
+		// Frames are due on a fixed grid so small delays don't add up, unless we fell
+		// a whole frame behind, then start the grid again from now
+		if (pacer.deadline == 0 || now > pacer.deadline + pacer.period) pacer.deadline = now;
+		pacer.deadline += pacer.period;
+
+		waitUntil(pacer.deadline);
+	}
+
+	recordFrame(SDL_GetTicksNS());
+}
+
+bool writeFrameStats(const char *path) {
+	FILE *out = fopen(path, "w");
+	if (out == NULL) {
+		fprintf(stderr, "Error! Couldn't write frame stats %s\n", path);
+		return false;
+	}
+
+	static const char *modeNames[] = {"timed", "vsync", "uncapped"};
+	fprintf(out, "# mode %s, target %.2f Hz, %" SDL_PRIu64 " frames\n", modeNames[pacer.mode],
+		pacer.period > 0 ? (double)SDL_NS_PER_SECOND / pacer.period : 0.0, pacer.frames);
+
+	if (pacer.frames > 0) {
+		fprintf(out, "# mean %.3f ms, min %.3f ms, max %.3f ms, late %" SDL_PRIu64 "\n",
+			pacer.total / 1e6 / pacer.frames, pacer.shortest / 1e6, pacer.longest / 1e6, pacer.late);
+	}
+
+	// Empty buckets are left out, the last one holds everything longer
+	fprintf(out, "# bucket start ms, frames\n");
+	for (int i = 0; i < PACER_BUCKETS; i++) {
+		if (pacer.histogram[i] == 0) continue;
+		fprintf(out, "%.3f%s %" SDL_PRIu64 "\n", i * PACER_BUCKET_US / 1e3, i == PACER_BUCKETS - 1 ? "+" : "", pacer.histogram[i]);
+	}
+
+	if (fclose(out) != 0) {
+		fprintf(stderr, "Error! Failed writing frame stats %s\n", path);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <SDL3/SDL_render.h>
+
+// Frame rate used when none is given
+const static double PACER_DEFAULT_RATE = 60.0;
+
+// Width of a frame time histogram bucket in microseconds, and how many there are
+// Frames longer than the last bucket are counted in it
+#define PACER_BUCKET_US 250
+#define PACER_BUCKETS 200
+
+// How frames are held to the target rate
+typedef enum PaceMode {
+	PACE_TIMED,    // Sleep, then spin the last stretch, until the next frame is due
+	PACE_VSYNC,    // Let the renderer wait for the display
+	PACE_UNCAPPED, // Don't wait at all
+} PaceMode;
+
+// Sets how frames are paced, and turns the renderer's VSync on or off to match
+// Rate is in frames per second and only used by PACE_TIMED, statsPath may be NULL
+// The frame time histogram is written to statsPath on destroyPacer()
+void initPacer(SDL_Renderer *renderer, PaceMode mode, double rate, const char *statsPath);
+
+// Writes the histogram if one was asked for
+void destroyPacer(void);
+
+// Waits until the next frame is due and records how long the frame that just ended took
+void waitForNextFrame(void);
+
+// Writes the frame time histogram and summary, returns false if the file couldn't be written
+bool writeFrameStats(const char *path);
@@ -0,0 +1,125 @@
+#include <box2d/box2d.h>
+#include <math.h>
+#include <string.h>
+
+#include "path.h"
+#include "utils.h"
+
+void buildPath(KinematicPath *path, const Kinematic *kinematic) {
+	memset(path, 0, sizeof(KinematicPath));
+	path->easing = kinematic->easing;
+
+	const int count = kinematic->pointCount < KINEMATIC_MAX_POINTS ? kinematic->pointCount : KINEMATIC_MAX_POINTS;
+	if (count < 2 || kinematic->time <= 0) return;
+
+	// Loop through the points and back to the first, SDL's y goes down and Box2D's up
+	float lengths[KINEMATIC_MAX_POINTS];
+	float total = 0;
+	for (int i = 0; i < count; i++) {
+		const b2Vec2 from = kinematic->points[i];
+		const b2Vec2 to = kinematic->points[(i + 1) % count];
+
+		path->segments[i].delta = (b2Vec2){pixelToMeter(to.x - from.x), -pixelToMeter(to.y - from.y)};
+		lengths[i] = b2Length(path->segments[i].delta);
+		total += lengths[i];
+	}
+	if (total <= 0) return;
+
+	for (int i = 0; i < count; i++) {
+		PathSegment *segment = &path->segments[i];
+		segment->duration = kinematic->time * lengths[i] / total;
+		if (segment->duration > 0) segment->velocity = b2MulSV(1.0f / segment->duration, segment->delta);
+	}
+	path->count = count;
+}
+
+// How far along a segment the platform is, from 0 to 1, at t from 0 to 1 of its time
+static float ease(Easing easing, float t) {
+	if (easing == EASE_SMOOTH) return t * t * (3.0f - 2.0f * t);
+	return t;
+}
+
+// Meters moved along a segment between two times in it
+static b2Vec2 segmentMove(const KinematicPath *path, const PathSegment *segment, float from, float to) {
+	if (segment->duration <= 0) return (b2Vec2){0, 0};
+
+	const float amount = ease(path->easing, to / segment->duration) - ease(path->easing, from / segment->duration);
+	return b2MulSV(amount, segment->delta);
+}
+
+// Velocity that moves a platform as far as its path goes over the next dt
+static b2Vec2 stepPath(const KinematicPath *path, PathState *state, float dt) {
+	const PathSegment *segment = &path->segments[state->segment];
+	const float end = state->elapsed + dt;
+
+	// Most steps stay inside one segment, and a linear one keeps its exact velocity
+	if (end < segment->duration) {
+		const b2Vec2 velocity = path->easing == EASE_LINEAR ? segment->velocity : b2MulSV(1.0f / dt, segmentMove(path, segment, state->elapsed, end));
+		state->elapsed = end;
+		return velocity;
+	}
+
+	// The step runs into the following segments, move as far as it goes through each
+	b2Vec2 moved = {0, 0};
+	float left = dt;
+
+	while (left > 0) {
+		segment = &path->segments[state->segment];
+		const float span = segment->duration - state->elapsed;
+
+		if (left < span) {
+			moved = b2Add(moved, segmentMove(path, segment, state->elapsed, state->elapsed + left));
+			state->elapsed += left;
+			break;
+		}
+
+		moved = b2Add(moved, segmentMove(path, segment, state->elapsed, segment->duration));
+		left -= span;
+		state->segment = (state->segment + 1) % path->count;
+		state->elapsed = 0;
+	}
+
+	return b2MulSV(1.0f / dt, moved);
+}
+
+void advancePaths(const KinematicPath *paths, PathState *states, const b2BodyId *bodies, const int *slots, int count, float dt) {
+	for (int i = 0; i < count; i++) {
+		const int slot = slots[i];
+		if (paths[slot].count == 0) continue;
+
+		const b2Vec2 velocity = stepPath(&paths[slot], &states[slot], dt);
+		if (velocity.x == states[slot].velocity.x && velocity.y == states[slot].velocity.y) continue;
+
+		b2Body_SetLinearVelocity(bodies[slot], velocity);
+		states[slot].velocity = velocity;
+	}
+}
+
+void skipPath(const KinematicPath *path, PathState *state, double time) {
+	if (path->count == 0) return;
+
+	// Whole laps end up back where they started
+	double lap = 0;
+	for (int i = 0; i < path->count; i++) lap += path->segments[i].duration;
+	time = fmod(time, lap);
+
+	while (time > 0) {
+		const float span = path->segments[state->segment].duration - state->elapsed;
+		if (time < span) {
+			state->elapsed += time;
+			return;
+		}
+
+		time -= span;
+		state->segment = (state->segment + 1) % path->count;
+		state->elapsed = 0;
+	}
+}
+
+b2Vec2 pathOffset(const KinematicPath *path, const PathState *state) {
+	b2Vec2 offset = {0, 0};
+	if (path->count == 0) return offset;
+
+	for (int i = 0; i < state->segment; i++) offset = b2Add(offset, path->segments[i].delta);
+	return b2Add(offset, segmentMove(path, &path->segments[state->segment], 0, state->elapsed));
+}
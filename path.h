@@ -0,0 +1,40 @@
+#pragma once
+#include <box2d/box2d.h>
+#include "game.h"
+
+// One leg of a platform's path, from one waypoint to the next
+typedef struct PathSegment {
+	b2Vec2 delta;    // Meters moved over the segment
+	b2Vec2 velocity; // Meters per second when the path is linear
+	float duration;  // Seconds
+} PathSegment;
+
+// A platform's path, worked out once when the level is built
+// A path with no segments doesn't move
+typedef struct KinematicPath {
+	int count;
+	Easing easing;
+	PathSegment segments[KINEMATIC_MAX_POINTS];
+} KinematicPath;
+
+// Where a platform is along its path, advanced by the fixed step so replays match
+typedef struct PathState {
+	int segment;
+	float elapsed;   // Seconds into the segment
+	b2Vec2 velocity; // Last velocity given to Box2D
+} PathState;
+
+// Works out the segments of a level object's path. Each segment takes a share of the
+// lap time by its length, so the platform keeps one speed around a linear path
+void buildPath(KinematicPath *path, const Kinematic *kinematic);
+
+// Moves the listed platforms one step along their paths, only the bodies whose velocity
+// changed are given the new one
+void advancePaths(const KinematicPath *paths, PathState *states, const b2BodyId *bodies, const int *slots, int count, float dt);
+
+// Moves a platform's state on by time seconds without touching its body, for catching up
+// a platform that was out of range
+void skipPath(const KinematicPath *path, PathState *state, double time);
+
+// Meters a platform is from where its path starts at a state
+b2Vec2 pathOffset(const KinematicPath *path, const PathState *state);
@@ -0,0 +1,144 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_thread.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "pipeline.h"
+
+extern World world;
+
+// Two snapshots: the one being drawn and the one the simulation thread is filling
+static FrameSnapshot snapshots[2];
+static int drawn = 0;
+
+static SDL_Thread *simulationThread = NULL;
+static SDL_Semaphore *simulationStart = NULL;
+static SDL_Semaphore *simulationDone = NULL;
+static bool started = false;
+static bool simulating = false;
+static bool quitting = false;
+
+// The frame asked for by beginSimulation()
+static int pendingSteps = 0;
+static float pendingAlpha = 0;
+
+static void simulateFrame(void) {
+	for (int i = 0; i < pendingSteps; i++) fixedUpdate();
+	takeFrameSnapshot(&snapshots[1 - drawn], pendingAlpha);
+}
+
+static int simulationMain(void *data) {
+	(void)data;
+
+	for (;;) {
+		SDL_WaitSemaphore(simulationStart);
+		if (quitting) break;
+
+		simulateFrame();
+		SDL_SignalSemaphore(simulationDone);
+	}
+	return 0;
+}
+
+void initPipeline(void) {
+	started = true;
+	quitting = false;
+
+	simulationStart = SDL_CreateSemaphore(0);
+	simulationDone = SDL_CreateSemaphore(0);
+	if (simulationStart != NULL && simulationDone != NULL) simulationThread = SDL_CreateThread(simulationMain, "simulation", NULL);
+
+	// Still play, just without drawing and simulating at the same time
+	if (simulationThread == NULL) SDL_Log("Couldn't create simulation thread: %s", SDL_GetError());
+}
+
+void destroyPipeline(void) {
+	endSimulation();
+
+	if (simulationThread != NULL) {
+		quitting = true;
+		SDL_SignalSemaphore(simulationStart);
+		SDL_WaitThread(simulationThread, NULL);
+		simulationThread = NULL;
+	}
+
+	if (simulationStart != NULL) SDL_DestroySemaphore(simulationStart);
+	if (simulationDone != NULL) SDL_DestroySemaphore(simulationDone);
+	simulationStart = simulationDone = NULL;
+
+	freeSnapshot(&snapshots[0]);
+	freeSnapshot(&snapshots[1]);
+	started = false;
+}
+
+void beginSimulation(int steps, float alpha) {
+	pendingSteps = steps;
+	pendingAlpha = alpha;
+	simulating = true;
+
+	if (simulationThread != NULL) SDL_SignalSemaphore(simulationStart);
+	else simulateFrame();
+}
+
+void endSimulation(void) {
+	if (!simulating) return;
+
+	if (simulationThread != NULL) SDL_WaitSemaphore(simulationDone);
+	simulating = false;
+	drawn = 1 - drawn;
+}
+
+const FrameSnapshot* drawnSnapshot(void) {
+	return &snapshots[drawn];
+}
+
+void refreshSnapshot(void) {
+	if (!started) return;
+	takeFrameSnapshot(&snapshots[drawn], world.accumulator / TIME_STEP);
+}
+
+// Grows an array to hold count items of the given size, doubling so it rarely grows
+static void* reserve(void *items, int *capacity, int count, size_t size) {
+	if (count <= *capacity) return items;
+
+	int grown = *capacity > 0 ? *capacity : 16;
+	while (grown < count) grown *= 2;
+
+	items = realloc(items, size * grown);
+	if (items == NULL) {
+		SDL_Log("Couldn't allocate a frame snapshot of %d objects", count);
+		exit(1);
+	}
+
+	*capacity = grown;
+	return items;
+}
+
+static void reserveLayer(SnapshotLayer *layer, int count) {
+	int colorCapacity = layer->capacity;
+	layer->colors = reserve(layer->colors, &colorCapacity, count, sizeof(Color));
+	layer->rects = reserve(layer->rects, &layer->capacity, count, sizeof(SDL_FRect));
+	layer->count = count;
+}
+
+void reserveSnapshot(FrameSnapshot *snapshot, int kinematics, int dynamics, int debris, int collectibles) {
+	reserveLayer(&snapshot->kinematics, kinematics);
+	reserveLayer(&snapshot->dynamics, dynamics);
+	reserveLayer(&snapshot->debris, debris);
+	snapshot->collectibleDraw = reserve(snapshot->collectibleDraw, &snapshot->collectibleCapacity, collectibles, sizeof(bool));
+	snapshot->collectibleCount = collectibles;
+}
+
+static void freeLayer(SnapshotLayer *layer) {
+	free(layer->rects);
+	free(layer->colors);
+	*layer = (SnapshotLayer){0};
+}
+
+void freeSnapshot(FrameSnapshot *snapshot) {
+	freeLayer(&snapshot->kinematics);
+	freeLayer(&snapshot->dynamics);
+	freeLayer(&snapshot->debris);
+	free(snapshot->collectibleDraw);
+	*snapshot = (FrameSnapshot){0};
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "game.h"
+
+// The moving objects of one type as they are to be drawn
+typedef struct SnapshotLayer {
+	int count;
+	int capacity;
+	SDL_FRect *rects; // In level pixels, the camera is added as they are drawn
+	Color *colors;
+} SnapshotLayer;
+
+// Everything render() reads about one simulated frame, copied out of the level so the
+// next frame can be simulated while this one is drawn
+// Layers are only updated where bodies moved since the snapshot was last taken
+typedef struct FrameSnapshot {
+	Uint64 frame; // Frame the snapshot was last taken on, 0 if never
+	Uint64 epoch; // Level the layers were filled from, see takeFrameSnapshot()
+	float xoffset;
+	float yoffset;
+	int collectiblesNeeded;
+	SnapshotLayer kinematics;
+	SnapshotLayer dynamics;
+	SnapshotLayer debris; // Filled in full every frame, there is only ever a little
+	int collectibleCount;
+	int collectibleCapacity;
+	bool *collectibleDraw;
+} FrameSnapshot;
+
+// Starts the simulation thread, until then frames are simulated on the calling thread
+void initPipeline(void);
+
+// Waits for the simulation thread to stop and frees the snapshots
+void destroyPipeline(void);
+
+// Starts simulating a frame: takes steps fixedUpdate()s, then snapshots the level
+// Alpha is how far the frame is past its last step, from 0 to 1
+void beginSimulation(int steps, float alpha);
+
+// Waits for the frame started by beginSimulation(), its snapshot is the next one drawn
+void endSimulation(void);
+
+// The snapshot of the last frame endSimulation() finished
+const FrameSnapshot* drawnSnapshot(void);
+
+// Snapshots the level as it is now to be drawn next, for when it changes between frames
+// (restarts, swaps). Only called while no frame is being simulated, does nothing before initPipeline()
+void refreshSnapshot(void);
+
+// Grows a snapshot's arrays to hold the given number of objects, exits if out of memory
+void reserveSnapshot(FrameSnapshot *snapshot, int kinematics, int dynamics, int debris, int collectibles);
+
+// Frees a snapshot's arrays
+void freeSnapshot(FrameSnapshot *snapshot);
+
+// Fills a snapshot from the level being played, done in game.c
+void takeFrameSnapshot(FrameSnapshot *snapshot, float alpha);
+
+// Draws a snapshot without presenting it, done in game.c
+void drawSnapshot(const FrameSnapshot *snapshot);
@@ -0,0 +1,104 @@
+#include <box2d/box2d.h>
+
+#include "pool.h"
+#include "utils.h"
+
+void buildEntityPool(EntityPool *pool, b2WorldId worldId, int capacity, float size, uint64_t maskBits, Arena *arena) {
+	const int n = capacity > 0 ? capacity : 1;
+
+	pool->capacity = capacity;
+	pool->count = 0;
+	pool->bodyId = arenaAlloc(arena, sizeof(b2BodyId) * n, _Alignof(b2BodyId));
+	pool->tag = arenaAlloc(arena, sizeof(Object*) * n, _Alignof(Object*));
+	pool->position = arenaAlloc(arena, sizeof(b2Vec2) * n, _Alignof(b2Vec2));
+	pool->previousPosition = arenaAlloc(arena, sizeof(b2Vec2) * n, _Alignof(b2Vec2));
+	pool->rect = arenaAlloc(arena, sizeof(SDL_FRect) * n, _Alignof(SDL_FRect));
+	pool->color = arenaAlloc(arena, sizeof(Color) * n, _Alignof(Color));
+	pool->lifetime = arenaAlloc(arena, sizeof(float) * n, _Alignof(float));
+
+	// Every body and shape is made now, play only turns them on and off
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.fixedRotation = true;
+	bodyDef.isEnabled = false;
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.density = 1.0f;
+	shapeDef.friction = 0.5f;
+	shapeDef.enableSensorEvents = false;
+	shapeDef.filter.categoryBits = CATEGORY_POOLED;
+	shapeDef.filter.maskBits = maskBits & ~CATEGORY_POOLED;
+
+	const b2Polygon box = b2MakeBox(pixelToMeter(size / 2), pixelToMeter(size / 2));
+
+	Object *tags = arenaCalloc(arena, n, sizeof(Object));
+
+	for (int i = 0; i < capacity; i++) {
+		tags[i].type = POOLED;
+		tags[i].slot = i;
+		pool->tag[i] = &tags[i];
+
+		bodyDef.userData = &tags[i];
+		pool->bodyId[i] = b2CreateBody(worldId, &bodyDef);
+		b2CreatePolygonShape(pool->bodyId[i], &shapeDef, &box);
+		pool->rect[i] = (SDL_FRect){0, 0, size, size};
+	}
+}
+
+int spawnEntity(EntityPool *pool, b2Vec2 position, b2Vec2 velocity, Color color, float lifetime) {
+	if (pool->count == pool->capacity) return -1;
+
+	const int index = pool->count++;
+	const b2BodyId bodyId = pool->bodyId[index];
+
+	b2Body_SetTransform(bodyId, position, (b2Rot){1, 0});
+	b2Body_SetLinearVelocity(bodyId, velocity);
+	b2Body_Enable(bodyId);
+
+	// Don't blend from wherever the body was when it was last used
+	pool->position[index] = pool->previousPosition[index] = position;
+	pool->color[index] = color;
+	pool->lifetime[index] = lifetime;
+	return index;
+}
+
+void despawnEntity(EntityPool *pool, int index) {
+	const int last = --pool->count;
+	const b2BodyId bodyId = pool->bodyId[index];
+	b2Body_Disable(bodyId);
+
+	// Keep the live entities packed, the freed body goes to the end with the other free ones
+	Object *tag = pool->tag[index];
+	pool->bodyId[index] = pool->bodyId[last];
+	pool->bodyId[last] = bodyId;
+	pool->tag[index] = pool->tag[last];
+	pool->tag[last] = tag;
+	pool->tag[index]->slot = index;
+	tag->slot = last;
+	pool->position[index] = pool->position[last];
+	pool->previousPosition[index] = pool->previousPosition[last];
+	pool->color[index] = pool->color[last];
+	pool->lifetime[index] = pool->lifetime[last];
+}
+
+void updateEntityPool(EntityPool *pool, float dt) {
+	// Backwards, so the entity moved into a despawned index has already been updated
+	for (int i = pool->count - 1; i >= 0; i--) {
+		pool->lifetime[i] -= dt;
+		if (pool->lifetime[i] <= 0) {
+			despawnEntity(pool, i);
+			continue;
+		}
+
+		// Entities that don't move in the step get no event, and stay where they were
+		pool->previousPosition[i] = pool->position[i];
+	}
+}
+
+void moveEntity(EntityPool *pool, int index, b2Vec2 position) {
+	pool->position[index] = position;
+}
+
+void clearEntityPool(EntityPool *pool) {
+	while (pool->count > 0) despawnEntity(pool, pool->count - 1);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <box2d/box2d.h>
+#include "game.h"
+#include "arena.h"
+
+// Entities spawned while a level is played, like debris. Every body is created disabled
+// when the level is built, spawning enables one and despawning disables it again, so
+// nothing is allocated or created during play and free bodies stay out of the broadphase
+// Live entities are packed at the start of every column, despawning moves the last one
+// into the freed index. Each body's user data is a POOLED object whose slot is its index,
+// so move events can find it, see moveEntity()
+typedef struct EntityPool {
+	int capacity;
+	int count; // Live entities
+	b2BodyId *bodyId;
+	Object **tag; // User data of each body
+	b2Vec2 *position;
+	b2Vec2 *previousPosition;
+	SDL_FRect *rect; // Only the size is used, in pixels
+	Color *color;
+	float *lifetime; // Seconds left before the entity despawns
+} EntityPool;
+
+// Creates capacity disabled square bodies of the given size in pixels, the columns go in the arena
+// They are in CATEGORY_POOLED and only collide with the categories in maskBits, never each other
+void buildEntityPool(EntityPool *pool, b2WorldId worldId, int capacity, float size, uint64_t maskBits, Arena *arena);
+
+// Enables a free body at a position and velocity in meters
+// Returns the entity's index, or -1 if every body is in use
+int spawnEntity(EntityPool *pool, b2Vec2 position, b2Vec2 velocity, Color color, float lifetime);
+
+// Disables an entity's body and frees it, the last live entity takes its index
+void despawnEntity(EntityPool *pool, int index);
+
+// Despawns the entities out of time and remembers where the rest are, before a step
+void updateEntityPool(EntityPool *pool, float dt);
+
+// Records where an entity moved to, from its move event after a step
+void moveEntity(EntityPool *pool, int index, b2Vec2 position);
+
+// Despawns every entity
+void clearEntityPool(EntityPool *pool);
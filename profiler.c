@@ -0,0 +1,250 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+#include <box2d/box2d.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "profiler.h"
+
+static const char *stageNames[PROFILE_STAGE_COUNT] = {
+	"events",
+	"inputs",
+	"physics",
+	"b2World_Step",
+	"draw",
+	"present",
+	"wait",
+};
+
+// One run of a stage, times are from SDL_GetTicksNS()
+typedef struct ProfileEvent {
+	ProfileStage stage;
+	Uint64 start;
+	Uint64 end;
+} ProfileEvent;
+
+// Box2D's timings summed over every step in a frame, in milliseconds
+typedef struct Box2DTimes {
+	float step;
+	float pairs;
+	float collide;
+	float solve;
+	float refit;
+	float sensors;
+} Box2DTimes;
+
+typedef struct ProfileFrame {
+	Uint64 start;
+	Uint64 end;
+	Uint64 stageTime[PROFILE_STAGE_COUNT];
+	Box2DTimes box2d;
+	int steps;
+	int eventCount;
+	ProfileEvent events[PROFILE_MAX_EVENTS];
+} ProfileFrame;
+
+typedef struct Profiler {
+	bool enabled;
+	bool overlay;
+	const char *tracePath;
+
+	// Ring buffer, frames[current] is the one being recorded
+	ProfileFrame frames[PROFILE_FRAMES];
+	int current;
+	int recorded; // Finished frames before current, at most PROFILE_FRAMES - 1 so current is never one
+
+	// When each stage was last started
+	Uint64 stageStart[PROFILE_STAGE_COUNT];
+} Profiler;
+
+static Profiler profiler;
+
+// Stages are timed on both the main and the simulation thread
+static SDL_SpinLock frameLock;
+
+void initProfiler(const char *tracePath) {
+	memset(&profiler, 0, sizeof(Profiler));
+	profiler.enabled = true;
+	profiler.tracePath = tracePath;
+}
+
+void destroyProfiler(void) {
+	if (profiler.enabled && profiler.tracePath != NULL) writeProfileTrace(profiler.tracePath);
+	profiler.enabled = false;
+}
+
+void profileFrameBegin(void) {
+	if (!profiler.enabled) return;
+
+	ProfileFrame *frame = &profiler.frames[profiler.current];
+	memset(frame, 0, sizeof(ProfileFrame));
+	frame->start = SDL_GetTicksNS();
+}
+
+void profileFrameEnd(void) {
+	if (!profiler.enabled) return;
+
+	profiler.frames[profiler.current].end = SDL_GetTicksNS();
+	profiler.current = (profiler.current + 1) % PROFILE_FRAMES;
+	if (profiler.recorded < PROFILE_FRAMES - 1) profiler.recorded++;
+}
+
+void profileBegin(ProfileStage stage) {
+	if (!profiler.enabled) return;
+	profiler.stageStart[stage] = SDL_GetTicksNS();
+}
+
+void profileEnd(ProfileStage stage) {
+	if (!profiler.enabled) return;
+
+	ProfileFrame *frame = &profiler.frames[profiler.current];
+	const Uint64 end = SDL_GetTicksNS();
+	const Uint64 start = profiler.stageStart[stage];
+
+	SDL_LockSpinlock(&frameLock);
+	frame->stageTime[stage] += end - start;
+	if (frame->eventCount < PROFILE_MAX_EVENTS) frame->events[frame->eventCount++] = (ProfileEvent){stage, start, end};
+	SDL_UnlockSpinlock(&frameLock);
+}
+
+void profileBox2D(b2WorldId worldId) {
+	if (!profiler.enabled) return;
+
+	ProfileFrame *frame = &profiler.frames[profiler.current];
+	const b2Profile p = b2World_GetProfile(worldId);
+
+	SDL_LockSpinlock(&frameLock);
+	frame->box2d.step += p.step;
+	frame->box2d.pairs += p.pairs;
+	frame->box2d.collide += p.collide;
+	frame->box2d.solve += p.solve;
+	frame->box2d.refit += p.refit;
+	frame->box2d.sensors += p.sensors;
+	frame->steps++;
+	SDL_UnlockSpinlock(&frameLock);
+}
+
+void toggleProfileOverlay(void) {
+	profiler.overlay = !profiler.overlay;
+}
+
+// Index of the i'th oldest recorded frame
+static int recordedFrame(int i) {
+	return (profiler.current - profiler.recorded + i + PROFILE_FRAMES) % PROFILE_FRAMES;
+}
+
+void renderProfileOverlay(SDL_Renderer *renderer) {
+	if (!profiler.enabled || !profiler.overlay || profiler.recorded == 0) return;
+
+	// Average and worst of every stage over the frames we have
+	double average[PROFILE_STAGE_COUNT] = {0};
+	double worst[PROFILE_STAGE_COUNT] = {0};
+	double frameAverage = 0;
+	double frameWorst = 0;
+	Box2DTimes box2d = {0};
+	int steps = 0;
+
+	for (int i = 0; i < profiler.recorded; i++) {
+		const ProfileFrame *frame = &profiler.frames[recordedFrame(i)];
+		const double frameMs = (frame->end - frame->start) / 1e6;
+
+		frameAverage += frameMs;
+		if (frameMs > frameWorst) frameWorst = frameMs;
+
+		for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+			const double ms = frame->stageTime[s] / 1e6;
+			average[s] += ms;
+			if (ms > worst[s]) worst[s] = ms;
+		}
+
+		box2d.step += frame->box2d.step;
+		box2d.pairs += frame->box2d.pairs;
+		box2d.collide += frame->box2d.collide;
+		box2d.solve += frame->box2d.solve;
+		box2d.refit += frame->box2d.refit;
+		box2d.sensors += frame->box2d.sensors;
+		steps += frame->steps;
+	}
+
+	const float n = profiler.recorded;
+	frameAverage /= n;
+
+	// Dark box behind the text so it reads over the level
+	const float x = 10;
+	float y = 50;
+	const float line = 10;
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+	SDL_RenderFillRect(renderer, &(SDL_FRect){x - 4, y - 4, 300, line * (PROFILE_STAGE_COUNT + 10) + 8});
+
+	SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+	SDL_RenderDebugTextFormat(renderer, x, y, "frame %6.2f ms (max %6.2f) %5.1f fps", frameAverage, frameWorst, frameAverage > 0 ? 1000.0 / frameAverage : 0.0);
+	y += line * 1.5f;
+
+	for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+		SDL_RenderDebugTextFormat(renderer, x, y, "%-13s %6.3f ms (max %6.3f)", stageNames[s], average[s] / n, worst[s]);
+		y += line;
+	}
+	y += line * 0.5f;
+
+	// Box2D times per step, the frame can take zero or several steps
+	const float perStep = steps > 0 ? steps : 1;
+	SDL_RenderDebugTextFormat(renderer, x, y, "box2d per step (%.2f steps/frame)", steps / n);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  step    %6.3f ms", box2d.step / perStep);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  pairs   %6.3f ms", box2d.pairs / perStep);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  collide %6.3f ms", box2d.collide / perStep);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  solve   %6.3f ms", box2d.solve / perStep);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  refit   %6.3f ms", box2d.refit / perStep);
+	y += line;
+	SDL_RenderDebugTextFormat(renderer, x, y, "  sensors %6.3f ms", box2d.sensors / perStep);
+}
+
+// Trace thread the stage runs on, the steps are simulated while the last frame is drawn
+static int stageThread(ProfileStage stage) {
+	return stage == PROFILE_INPUTS || stage == PROFILE_PHYSICS || stage == PROFILE_STEP ? 2 : 1;
+}
+
+bool writeProfileTrace(const char *path) {
+	FILE *out = fopen(path, "w");
+	if (out == NULL) {
+		fprintf(stderr, "Error! Couldn't write trace %s\n", path);
+		return false;
+	}
+
+	// Chrome trace timestamps are in microseconds
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+	fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"simulation\"}}");
+
+	for (int i = 0; i < profiler.recorded; i++) {
+		const ProfileFrame *frame = &profiler.frames[recordedFrame(i)];
+
+		fprintf(out, ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			frame->start / 1e3, (frame->end - frame->start) / 1e3);
+
+		for (int e = 0; e < frame->eventCount; e++) {
+			const ProfileEvent *event = &frame->events[e];
+			fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				stageNames[event->stage], stageThread(event->stage), event->start / 1e3, (event->end - event->start) / 1e3);
+		}
+
+		// Box2D's breakdown for the frame as counters, in milliseconds
+		fprintf(out, ",\n{\"name\":\"box2d\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"pairs\":%.4f,\"collide\":%.4f,\"solve\":%.4f,\"refit\":%.4f,\"sensors\":%.4f}}",
+			frame->start / 1e3, frame->box2d.pairs, frame->box2d.collide, frame->box2d.solve, frame->box2d.refit, frame->box2d.sensors);
+	}
+
+	fprintf(out, "\n]}\n");
+
+	if (fclose(out) != 0) {
+		fprintf(stderr, "Error! Failed writing trace %s\n", path);
+		return false;
+	}
+
+	printf("Wrote %d frames to %s\n", profiler.recorded, path);
+	return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <SDL3/SDL_render.h>
+#include <box2d/box2d.h>
+
+// Frames kept in the ring buffer, used for the overlay averages and the trace
+#define PROFILE_FRAMES 240
+
+// Timed spans kept per frame, later spans in a frame are dropped
+#define PROFILE_MAX_EVENTS 64
+
+// Stages of a frame that get timed
+typedef enum ProfileStage {
+	PROFILE_EVENTS,  // handleEvents()
+	PROFILE_INPUTS,  // handleInputs()
+	PROFILE_PHYSICS, // handlePhysics(), includes PROFILE_STEP
+	PROFILE_STEP,    // b2World_Step()
+	PROFILE_DRAW,    // Building the frame in render()
+	PROFILE_PRESENT, // SDL_RenderPresent()
+	PROFILE_WAIT,    // Sleeping until the next frame
+	PROFILE_STAGE_COUNT
+} ProfileStage;
+
+// Starts recording, trace is written to tracePath on destroyProfiler(), may be NULL
+// Until this is called every profile function does nothing
+void initProfiler(const char *tracePath);
+
+// Writes the trace if one was asked for
+void destroyProfiler(void);
+
+// Marks the start and end of a frame, every stage timed between them belongs to it
+void profileFrameBegin(void);
+void profileFrameEnd(void);
+
+// Times one run of a stage, a stage can run several times in a frame
+void profileBegin(ProfileStage stage);
+void profileEnd(ProfileStage stage);
+
+// Adds Box2D's own timings for the step that just ran to the current frame
+void profileBox2D(b2WorldId worldId);
+
+// Shows or hides the overlay
+void toggleProfileOverlay(void);
+
+// Draws the per stage averages and the Box2D breakdown over the last frames
+void renderProfileOverlay(SDL_Renderer *renderer);
+
+// Writes the recorded frames as Chrome trace JSON (chrome://tracing, Perfetto)
+// Returns false if the file couldn't be written
+bool writeProfileTrace(const char *path);
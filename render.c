@@ -1,27 +1,218 @@
 #include <SDL3/SDL_render.h>
+#include <SDL3/SDL_surface.h>
+#include <stdlib.h>
 #include "render.h"
 
-void renderRectangle(SDL_Renderer *renderer, Object* object) {
-	const Color c = object->color;
+// A circle rasterized once into a texture, keyed by radius and color
+typedef struct CircleTexture {
+	int radius;
+	Color color;
+	SDL_Texture *texture;
+} CircleTexture;
 
-	SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
-	SDL_RenderFillRect(renderer, &object->rect);
+// A circle waiting to be drawn in the next batch
+typedef struct CircleQuad {
+	int texture;
+	SDL_FRect rect;
+} CircleQuad;
+
+static CircleTexture *circleCache = NULL;
+static int circleCacheCount = 0;
+static int circleCacheCapacity = 0;
+
+static CircleQuad *circleQueue = NULL;
+static int circleQueueCount = 0;
+static int circleQueueCapacity = 0;
+
+static SDL_Vertex *circleVertices = NULL;
+static int *circleIndices = NULL;
+static int circleBatchCapacity = 0;
+
+// Rectangles are written straight into the vertex and index buffers as they are queued
+static SDL_Vertex *rectVertices = NULL;
+static int *rectIndices = NULL;
+static int rectCount = 0;
+static int rectCapacity = 0;
+
+// Resizes a batch buffer to size bytes, running out of memory mid frame isn't recoverable
+static void* growBuffer(void *items, size_t size) {
+	void *grown = realloc(items, size);
+	if (grown == NULL) {
+		SDL_Log("Couldn't grow a render batch to %zu bytes", size);
+		exit(1);
+	}
+	return grown;
+}
+
+void renderRectangle(const SDL_FRect *rect, Color c) {
+	if (rectCount == rectCapacity) {
+		rectCapacity = rectCapacity ? rectCapacity * 2 : 256;
+		rectVertices = growBuffer(rectVertices, sizeof(SDL_Vertex) * 4 * rectCapacity);
+		rectIndices = growBuffer(rectIndices, sizeof(int) * 6 * rectCapacity);
+	}
+
+	const SDL_FColor color = {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+	const SDL_FRect r = *rect;
+	SDL_Vertex *v = &rectVertices[rectCount * 4];
+	int *index = &rectIndices[rectCount * 6];
+	const int base = rectCount * 4;
+
+	v[0] = (SDL_Vertex){{r.x, r.y}, color, {0.0f, 0.0f}};
+	v[1] = (SDL_Vertex){{r.x + r.w, r.y}, color, {0.0f, 0.0f}};
+	v[2] = (SDL_Vertex){{r.x + r.w, r.y + r.h}, color, {0.0f, 0.0f}};
+	v[3] = (SDL_Vertex){{r.x, r.y + r.h}, color, {0.0f, 0.0f}};
+
+	index[0] = base; index[1] = base + 1; index[2] = base + 2;
+	index[3] = base; index[4] = base + 2; index[5] = base + 3;
+	rectCount++;
+}
+
+void flushRectangles(SDL_Renderer *renderer) {
+	if (rectCount == 0) return;
+
+	// Queued in draw order, so later rectangles still cover earlier ones
+	SDL_RenderGeometry(renderer, NULL, rectVertices, rectCount * 4, rectIndices, rectCount * 6);
+	rectCount = 0;
 }
 
+// Rasterize a filled circle of the given radius into a texture
 // https://stackoverflow.com/questions/65723827/sdl2-function-to-draw-a-filled-circle
-void renderCircle(SDL_Renderer *renderer, Object *object) {
-	const int radius = object->p.w / 2;
-	const int centerX = object->rect.x + radius;
-	const int centerY = object->rect.y + radius;
-	const Color c = object->color; 
+static SDL_Texture* createCircleTexture(SDL_Renderer *renderer, int radius, Color c) {
+	const int size = radius * 2 + 1;
+
+	SDL_Surface *surface = SDL_CreateSurface(size, size, SDL_PIXELFORMAT_RGBA32);
+	if (surface == NULL) {
+		SDL_Log("Couldn't create circle surface: %s", SDL_GetError());
+		return NULL;
+	}
 
-	SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+	// The renderer draws with blending off, so circles were always opaque on screen.
+	// Keep them opaque inside the radius and transparent outside of it
+	const Uint32 inside = SDL_MapSurfaceRGBA(surface, c.r, c.g, c.b, SDL_ALPHA_OPAQUE);
+	const Uint32 outside = SDL_MapSurfaceRGBA(surface, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
 
 	for (int y = -radius; y <= radius; y++) {
+		Uint32 *row = (Uint32*)((Uint8*)surface->pixels + (y + radius) * surface->pitch);
+
 		for (int x = -radius; x <= radius; x++) {
-			if ((x * x + y * y) <= radius * radius) {
-				SDL_RenderPoint(renderer, centerX + x, centerY + y);
-			}
+			row[x + radius] = (x * x + y * y) <= radius * radius ? inside : outside;
 		}
 	}
+
+	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_DestroySurface(surface);
+
+	if (texture == NULL) {
+		SDL_Log("Couldn't create circle texture: %s", SDL_GetError());
+		return NULL;
+	}
+
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+	return texture;
+}
+
+// Find the cached texture for this radius and color, creating it the first time
+// Returns the index into the cache, or -1 if the texture couldn't be created
+static int getCircleTexture(SDL_Renderer *renderer, int radius, Color c) {
+	for (int i = 0; i < circleCacheCount; i++) {
+		const CircleTexture *entry = &circleCache[i];
+
+		if (entry->radius == radius && entry->color.r == c.r && entry->color.g == c.g &&
+			entry->color.b == c.b && entry->color.a == c.a) return i;
+	}
+
+	SDL_Texture *texture = createCircleTexture(renderer, radius, c);
+	if (texture == NULL) return -1;
+
+	if (circleCacheCount == circleCacheCapacity) {
+		circleCacheCapacity = circleCacheCapacity ? circleCacheCapacity * 2 : 4;
+		circleCache = growBuffer(circleCache, sizeof(CircleTexture) * circleCacheCapacity);
+	}
+
+	circleCache[circleCacheCount] = (CircleTexture){radius, c, texture};
+	return circleCacheCount++;
+}
+
+void renderCircle(SDL_Renderer *renderer, const SDL_FRect *rect, Color color) {
+	const int radius = rect->w / 2;
+	const int centerX = rect->x + radius;
+	const int centerY = rect->y + radius;
+
+	const int texture = getCircleTexture(renderer, radius, color);
+	if (texture < 0) return;
+
+	if (circleQueueCount == circleQueueCapacity) {
+		circleQueueCapacity = circleQueueCapacity ? circleQueueCapacity * 2 : 32;
+		circleQueue = growBuffer(circleQueue, sizeof(CircleQuad) * circleQueueCapacity);
+	}
+
+	// Same pixels the per point version covered: the center +/- radius, inclusive
+	circleQueue[circleQueueCount++] = (CircleQuad){
+		.texture = texture,
+		.rect = (SDL_FRect){centerX - radius, centerY - radius, radius * 2 + 1, radius * 2 + 1}
+	};
+}
+
+void flushCircles(SDL_Renderer *renderer) {
+	if (circleQueueCount == 0) return;
+
+	if (circleQueueCount > circleBatchCapacity) {
+		circleBatchCapacity = circleQueueCapacity;
+		circleVertices = growBuffer(circleVertices, sizeof(SDL_Vertex) * 4 * circleBatchCapacity);
+		circleIndices = growBuffer(circleIndices, sizeof(int) * 6 * circleBatchCapacity);
+	}
+
+	const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+
+	// One geometry submission per cached texture, normally just one for every coin on screen
+	for (int t = 0; t < circleCacheCount; t++) {
+		int quads = 0;
+
+		for (int i = 0; i < circleQueueCount; i++) {
+			if (circleQueue[i].texture != t) continue;
+
+			const SDL_FRect r = circleQueue[i].rect;
+			SDL_Vertex *v = &circleVertices[quads * 4];
+			int *index = &circleIndices[quads * 6];
+			const int base = quads * 4;
+
+			v[0] = (SDL_Vertex){{r.x, r.y}, white, {0.0f, 0.0f}};
+			v[1] = (SDL_Vertex){{r.x + r.w, r.y}, white, {1.0f, 0.0f}};
+			v[2] = (SDL_Vertex){{r.x + r.w, r.y + r.h}, white, {1.0f, 1.0f}};
+			v[3] = (SDL_Vertex){{r.x, r.y + r.h}, white, {0.0f, 1.0f}};
+
+			index[0] = base; index[1] = base + 1; index[2] = base + 2;
+			index[3] = base; index[4] = base + 2; index[5] = base + 3;
+			quads++;
+		}
+
+		if (quads == 0) continue;
+		SDL_RenderGeometry(renderer, circleCache[t].texture, circleVertices, quads * 4, circleIndices, quads * 6);
+	}
+
+	circleQueueCount = 0;
+}
+
+void destroyRenderCache(void) {
+	for (int i = 0; i < circleCacheCount; i++) SDL_DestroyTexture(circleCache[i].texture);
+
+	free(circleCache);
+	free(circleQueue);
+	free(circleVertices);
+	free(circleIndices);
+	free(rectVertices);
+	free(rectIndices);
+
+	circleCache = NULL;
+	circleQueue = NULL;
+	circleVertices = NULL;
+	circleIndices = NULL;
+	circleCacheCount = circleCacheCapacity = 0;
+	circleQueueCount = circleQueueCapacity = 0;
+	circleBatchCapacity = 0;
+
+	rectVertices = NULL;
+	rectIndices = NULL;
+	rectCount = rectCapacity = 0;
 }
@@ -4,8 +4,17 @@
 #include <SDL3/SDL_render.h>
 #include <box2d/math_functions.h>
 
-// Renders a rectangle on the screen
-void renderRectangle(SDL_Renderer* renderer, Object* object); 
+// Queues a filled rectangle to be drawn on the next flushRectangles()
+void renderRectangle(const SDL_FRect* rect, Color color);
 
-// Renders a circle on the screen
-void renderCircle(SDL_Renderer* renderer, Object* object); 
+// Draws every queued rectangle in one untextured geometry call, colors are carried per vertex
+void flushRectangles(SDL_Renderer* renderer);
+
+// Queues a circle filling the rectangle's width to be drawn from a cached texture on the next flushCircles()
+void renderCircle(SDL_Renderer* renderer, const SDL_FRect* rect, Color color);
+
+// Draws every queued circle, batched into one geometry call per cached texture
+void flushCircles(SDL_Renderer* renderer);
+
+// Destroys the cached circle textures and frees the batch buffers, must be called before the renderer is destroyed
+void destroyRenderCache(void);
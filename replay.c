@@ -0,0 +1,168 @@
+#include <SDL3/SDL_stdinc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game.h"
+#include "replay.h"
+
+// The file being recorded to and the run of ticks not written yet
+static FILE *recording = NULL;
+static ReplayRun pending = {0, 0};
+
+static void writeRun(ReplayRun run) {
+	if (run.count == 0) return;
+	fwrite(&run, sizeof(ReplayRun), 1, recording);
+}
+
+bool startRecording(const char *path, const char **levelPaths, int levelCount) {
+	if ((Uint32)levelCount > REPLAY_MAX_LEVELS) {
+		fprintf(stderr, "Error! Can't record more than %u levels\n", REPLAY_MAX_LEVELS);
+		return false;
+	}
+	// Paths are stored with a Uint16 length
+	for (int l = 0; l < levelCount; l++) {
+		if (strlen(levelPaths[l]) > SDL_MAX_UINT16) {
+			fprintf(stderr, "Error! Level path %s is too long to record\n", levelPaths[l]);
+			return false;
+		}
+	}
+
+	recording = fopen(path, "wb");
+	if (recording == NULL) {
+		fprintf(stderr, "Error! Couldn't write replay %s\n", path);
+		return false;
+	}
+
+	ReplayHeader header;
+	memset(&header, 0, sizeof(ReplayHeader));
+	memcpy(header.magic, REPLAY_MAGIC, 4);
+	header.version = REPLAY_VERSION;
+	header.timeStep = TIME_STEP;
+	header.levelCount = levelCount;
+	fwrite(&header, sizeof(ReplayHeader), 1, recording);
+
+	for (int l = 0; l < levelCount; l++) {
+		const Uint16 length = strlen(levelPaths[l]);
+		fwrite(&length, sizeof(Uint16), 1, recording);
+		fwrite(levelPaths[l], 1, length, recording);
+	}
+
+	pending = (ReplayRun){0, 0};
+	return true;
+}
+
+void recordInput(Uint8 input) {
+	if (recording == NULL) return;
+
+	const Uint8 code = input & REPLAY_INPUT_MASK;
+
+	// Inputs are held for many ticks, so only write when they change or the count is full
+	if (pending.count > 0 && (pending.code != code || pending.count == 255)) {
+		writeRun(pending);
+		pending.count = 0;
+	}
+
+	pending.code = code;
+	pending.count++;
+}
+
+// Markers end the current run of ticks
+static void recordMarker(Uint8 code) {
+	if (recording == NULL) return;
+
+	writeRun(pending);
+	pending.count = 0;
+	writeRun((ReplayRun){code, 1});
+}
+
+void recordRestart(void) {
+	recordMarker(REPLAY_RESTART);
+}
+
+void recordLevelEnd(void) {
+	recordMarker(REPLAY_LEVEL_END);
+}
+
+void stopRecording(void) {
+	if (recording == NULL) return;
+
+	writeRun(pending);
+	if (fclose(recording) != 0) fprintf(stderr, "Error! Failed writing replay\n");
+	recording = NULL;
+}
+
+bool readReplay(const char *path, Replay *replay) {
+	memset(replay, 0, sizeof(Replay));
+
+	FILE *in = fopen(path, "rb");
+	if (in == NULL) {
+		fprintf(stderr, "Error! Couldn't open replay %s\n", path);
+		return false;
+	}
+
+	ReplayHeader header;
+	if (fread(&header, sizeof(ReplayHeader), 1, in) != 1 || memcmp(header.magic, REPLAY_MAGIC, 4) != 0 ||
+		header.version != REPLAY_VERSION) goto error;
+
+	// Inputs only replay the same way at the step they were recorded at
+	if (header.timeStep != TIME_STEP) {
+		fprintf(stderr, "Error! Replay %s was recorded at a different time step\n", path);
+		fclose(in);
+		return false;
+	}
+
+	if (header.levelCount > REPLAY_MAX_LEVELS) goto error;
+
+	// Count the levels only once there is somewhere to keep them, freeReplay() goes by it
+	if (header.levelCount > 0) {
+		replay->levelPaths = calloc(header.levelCount, sizeof(char*));
+		if (replay->levelPaths == NULL) goto outOfMemory;
+		replay->levelCount = header.levelCount;
+	}
+
+	for (Uint32 l = 0; l < header.levelCount; l++) {
+		Uint16 length;
+		if (fread(&length, sizeof(Uint16), 1, in) != 1) goto error;
+
+		replay->levelPaths[l] = malloc(length + 1);
+		if (replay->levelPaths[l] == NULL) goto outOfMemory;
+		if (fread(replay->levelPaths[l], 1, length, in) != length) goto error;
+		replay->levelPaths[l][length] = '\0';
+	}
+
+	// The rest of the file is runs
+	int capacity = 0;
+	ReplayRun run;
+	while (fread(&run, sizeof(ReplayRun), 1, in) == 1) {
+		if (replay->runCount == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			ReplayRun *grown = realloc(replay->runs, sizeof(ReplayRun) * capacity);
+			if (grown == NULL) goto outOfMemory;
+			replay->runs = grown;
+		}
+		replay->runs[replay->runCount++] = run;
+	}
+
+	fclose(in);
+	return true;
+
+outOfMemory:
+	fprintf(stderr, "Error! Ran out of memory reading replay %s\n", path);
+	goto failed;
+
+error:
+	fprintf(stderr, "Error! %s is not a replay\n", path);
+failed:
+	fclose(in);
+	freeReplay(replay);
+	return false;
+}
+
+void freeReplay(Replay *replay) {
+	for (int l = 0; l < replay->levelCount; l++) free(replay->levelPaths[l]);
+
+	free(replay->levelPaths);
+	free(replay->runs);
+	memset(replay, 0, sizeof(Replay));
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#define REPLAY_MAGIC "SBRP"
+const static Uint32 REPLAY_VERSION = 1;
+
+// Most levels a replay can name, so a corrupt count can't ask for gigabytes
+const static Uint32 REPLAY_MAX_LEVELS = 4096;
+
+// A replay is the header, the level paths, then (code, count) byte pairs:
+// count ticks in a row holding the inputs in the low bits of code, or a marker
+const static Uint8 REPLAY_INPUT_MASK = 0x07;
+const static Uint8 REPLAY_RESTART = 0x40;   // restartLevel() was called
+const static Uint8 REPLAY_LEVEL_END = 0x80; // The level was cleared, the next one starts
+
+typedef struct ReplayHeader {
+	char magic[4];
+	Uint32 version;
+	float timeStep;  // TIME_STEP the replay was recorded with
+	Uint32 levelCount; // Followed by levelCount Uint16 lengths and path bytes
+} ReplayHeader;
+
+// One run of identical ticks or a marker
+typedef struct ReplayRun {
+	Uint8 code;
+	Uint8 count;
+} ReplayRun;
+
+// A replay read back into memory
+typedef struct Replay {
+	int levelCount;
+	char **levelPaths;
+	int runCount;
+	ReplayRun *runs;
+} Replay;
+
+// Starts writing every fixed step's inputs to path, along with the levels being played
+// Returns false if the file couldn't be opened, or the levels don't fit in a replay
+bool startRecording(const char *path, const char **levelPaths, int levelCount);
+
+// Record one fixed step's inputs, does nothing unless recording
+void recordInput(Uint8 input);
+
+// Record that the level was restarted or cleared
+void recordRestart(void);
+void recordLevelEnd(void);
+
+// Flushes and closes the recording
+void stopRecording(void);
+
+// Reads a whole replay file, returns false if it isn't one
+bool readReplay(const char *path, Replay *replay);
+
+// Frees what readReplay() allocated
+void freeReplay(Replay *replay);
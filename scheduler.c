@@ -0,0 +1,307 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <box2d/box2d.h>
+#include <stdlib.h>
+
+#include "scheduler.h"
+
+// Task slots are reused round robin. Box2D finishes every task before
+// b2World_Step returns and uses far fewer than this per step
+#define MAX_TASKS 256
+
+// Ranges each worker can have queued at once, must be a power of two
+#define DEQUE_CAPACITY 1024
+
+// Pauses finishTask() spins for with nothing to take before it sleeps until the task is done
+#define FINISH_SPINS 64
+
+// A Box2D task, split into ranges that can run on any worker
+typedef struct Task {
+	b2TaskCallback *callback;
+	void *context;
+	SDL_AtomicInt remaining;
+} Task;
+
+// A slice [start, end) of a task's items
+typedef struct TaskRange {
+	Task *task;
+	int start;
+	int end;
+} TaskRange;
+
+// Each worker pushes and pops at the bottom of its own deque,
+// idle workers steal from the top of everyone else's
+typedef struct WorkerDeque {
+	SDL_Mutex *lock;
+	TaskRange items[DEQUE_CAPACITY];
+	int top;
+	int bottom;
+} WorkerDeque;
+
+typedef struct Worker {
+	WorkerDeque deque;
+	SDL_Thread *thread;
+	int index;
+} Worker;
+
+typedef struct Scheduler {
+	Worker workers[MAX_WORKERS];
+	int workerCount;
+	Task tasks[MAX_TASKS];
+	int nextTask;
+	int nextDeque;
+	SDL_AtomicInt pending;
+	SDL_AtomicInt quit;
+	SDL_Mutex *sleepLock;
+	SDL_Condition *wake;
+	SDL_Condition *done; // Signalled when the last range of a task finishes
+} Scheduler;
+
+static Scheduler scheduler;
+
+static bool pushRange(WorkerDeque *deque, TaskRange range) {
+	SDL_LockMutex(deque->lock);
+
+	if (deque->bottom - deque->top == DEQUE_CAPACITY) {
+		SDL_UnlockMutex(deque->lock);
+		return false;
+	}
+
+	deque->items[deque->bottom & (DEQUE_CAPACITY - 1)] = range;
+	deque->bottom++;
+
+	SDL_UnlockMutex(deque->lock);
+	return true;
+}
+
+// Owner side: newest range first, it is most likely still in cache
+static bool popRange(WorkerDeque *deque, TaskRange *range) {
+	SDL_LockMutex(deque->lock);
+
+	if (deque->bottom == deque->top) {
+		SDL_UnlockMutex(deque->lock);
+		return false;
+	}
+
+	deque->bottom--;
+	*range = deque->items[deque->bottom & (DEQUE_CAPACITY - 1)];
+
+	SDL_UnlockMutex(deque->lock);
+	return true;
+}
+
+// Thief side: oldest range first
+static bool stealRange(WorkerDeque *deque, TaskRange *range) {
+	SDL_LockMutex(deque->lock);
+
+	if (deque->bottom == deque->top) {
+		SDL_UnlockMutex(deque->lock);
+		return false;
+	}
+
+	*range = deque->items[deque->top & (DEQUE_CAPACITY - 1)];
+	deque->top++;
+
+	SDL_UnlockMutex(deque->lock);
+	return true;
+}
+
+// Take a range from our own deque, or steal one from another worker
+static bool takeRange(int workerIndex, TaskRange *range) {
+	if (SDL_GetAtomicInt(&scheduler.pending) == 0) return false;
+
+	bool found = popRange(&scheduler.workers[workerIndex].deque, range);
+
+	for (int i = 1; !found && i < scheduler.workerCount; i++) {
+		const int victim = (workerIndex + i) % scheduler.workerCount;
+		found = stealRange(&scheduler.workers[victim].deque, range);
+	}
+
+	if (found) SDL_AddAtomicInt(&scheduler.pending, -1);
+	return found;
+}
+
+static void runRange(const TaskRange *range, int workerIndex) {
+	range->task->callback(range->start, range->end, workerIndex, range->task->context);
+
+	// The last range wakes finishTask() in case it went to sleep waiting for it
+	if (SDL_AddAtomicInt(&range->task->remaining, -1) == 1) {
+		SDL_LockMutex(scheduler.sleepLock);
+		SDL_BroadcastCondition(scheduler.done);
+		SDL_UnlockMutex(scheduler.sleepLock);
+	}
+}
+
+static int workerMain(void *data) {
+	Worker *worker = data;
+	TaskRange range;
+
+	while (!SDL_GetAtomicInt(&scheduler.quit)) {
+		if (takeRange(worker->index, &range)) {
+			runRange(&range, worker->index);
+			continue;
+		}
+
+		// Nothing to do, sleep until more ranges are queued
+		SDL_LockMutex(scheduler.sleepLock);
+		while (SDL_GetAtomicInt(&scheduler.pending) == 0 && !SDL_GetAtomicInt(&scheduler.quit)) {
+			SDL_WaitCondition(scheduler.wake, scheduler.sleepLock);
+		}
+		SDL_UnlockMutex(scheduler.sleepLock);
+	}
+
+	return 0;
+}
+
+static void* enqueueTask(b2TaskCallback *callback, int itemCount, int minRange, void *taskContext, void *userContext) {
+	(void)userContext;
+
+	// Single threaded, just do the work now. Returning NULL tells Box2D not to call finishTask
+	if (scheduler.workerCount == 1) {
+		callback(0, itemCount, 0, taskContext);
+		return NULL;
+	}
+
+	Task *task = &scheduler.tasks[scheduler.nextTask];
+	scheduler.nextTask = (scheduler.nextTask + 1) % MAX_TASKS;
+
+	// Split into a few ranges per worker so there is something left to steal
+	// when the ranges take uneven time, but never smaller than Box2D asks for
+	if (minRange < 1) minRange = 1;
+	int rangeCount = itemCount / minRange;
+	if (rangeCount > scheduler.workerCount * 4) rangeCount = scheduler.workerCount * 4;
+	if (rangeCount < 1) rangeCount = 1;
+
+	task->callback = callback;
+	task->context = taskContext;
+	SDL_SetAtomicInt(&task->remaining, rangeCount);
+
+	const int rangeSize = itemCount / rangeCount;
+	int start = 0;
+
+	for (int i = 0; i < rangeCount; i++) {
+		const int end = i == rangeCount - 1 ? itemCount : start + rangeSize;
+		const TaskRange range = {task, start, end};
+
+		// Spread the ranges over every worker's deque
+		WorkerDeque *deque = &scheduler.workers[scheduler.nextDeque].deque;
+		scheduler.nextDeque = (scheduler.nextDeque + 1) % scheduler.workerCount;
+
+		// Count it before it is visible so a thief never sees pending drop below zero
+		SDL_AddAtomicInt(&scheduler.pending, 1);
+		if (!pushRange(deque, range)) {
+			SDL_AddAtomicInt(&scheduler.pending, -1);
+			runRange(&range, 0);
+		}
+
+		start = end;
+	}
+
+	// Wake the sleeping workers, holding the lock so none of them miss it
+	SDL_LockMutex(scheduler.sleepLock);
+	SDL_BroadcastCondition(scheduler.wake);
+	SDL_UnlockMutex(scheduler.sleepLock);
+
+	return task;
+}
+
+static void finishTask(void *userTask, void *userContext) {
+	(void)userContext;
+
+	Task *task = userTask;
+	TaskRange range;
+	int spins = 0;
+
+	// The thread stepping the world is worker 0, help out until every range of this task is done
+	while (SDL_GetAtomicInt(&task->remaining) > 0) {
+		if (takeRange(0, &range)) {
+			runRange(&range, 0);
+			spins = 0;
+			continue;
+		}
+
+		if (spins++ < FINISH_SPINS) {
+			SDL_CPUPauseInstruction();
+			continue;
+		}
+
+		// Only this thread queues ranges, so with none left to take the last ones are
+		// running on other workers. Sleep until they are done instead of burning a core
+		SDL_LockMutex(scheduler.sleepLock);
+		while (SDL_GetAtomicInt(&task->remaining) > 0) SDL_WaitCondition(scheduler.done, scheduler.sleepLock);
+		SDL_UnlockMutex(scheduler.sleepLock);
+	}
+}
+
+int defaultWorkerCount() {
+	int count = SDL_GetNumLogicalCPUCores();
+
+	if (count < 1) count = 1;
+	if (count > DEFAULT_MAX_WORKERS) count = DEFAULT_MAX_WORKERS;
+	return count;
+}
+
+void initScheduler(int workerCount) {
+	if (workerCount < 1) workerCount = 1;
+	if (workerCount > MAX_WORKERS) workerCount = MAX_WORKERS;
+
+	scheduler.workerCount = workerCount;
+	scheduler.nextTask = 0;
+	scheduler.nextDeque = 0;
+	SDL_SetAtomicInt(&scheduler.pending, 0);
+	SDL_SetAtomicInt(&scheduler.quit, 0);
+	scheduler.sleepLock = SDL_CreateMutex();
+	scheduler.wake = SDL_CreateCondition();
+	scheduler.done = SDL_CreateCondition();
+
+	for (int i = 0; i < workerCount; i++) {
+		Worker *worker = &scheduler.workers[i];
+
+		worker->index = i;
+		worker->deque.lock = SDL_CreateMutex();
+		worker->deque.top = worker->deque.bottom = 0;
+		worker->thread = NULL;
+
+		// Worker 0 is the thread stepping the world, it works while waiting in finishTask()
+		if (i == 0) continue;
+
+		worker->thread = SDL_CreateThread(workerMain, "box2d worker", worker);
+		if (worker->thread == NULL) {
+			SDL_Log("Couldn't create worker thread: %s", SDL_GetError());
+			exit(1);
+		}
+	}
+}
+
+void destroyScheduler() {
+	SDL_SetAtomicInt(&scheduler.quit, 1);
+
+	SDL_LockMutex(scheduler.sleepLock);
+	SDL_BroadcastCondition(scheduler.wake);
+	SDL_UnlockMutex(scheduler.sleepLock);
+
+	for (int i = 0; i < scheduler.workerCount; i++) {
+		Worker *worker = &scheduler.workers[i];
+
+		if (worker->thread != NULL) SDL_WaitThread(worker->thread, NULL);
+		SDL_DestroyMutex(worker->deque.lock);
+	}
+
+	SDL_DestroyCondition(scheduler.wake);
+	SDL_DestroyCondition(scheduler.done);
+	SDL_DestroyMutex(scheduler.sleepLock);
+	scheduler.workerCount = 0;
+}
+
+int getWorkerCount() {
+	return scheduler.workerCount;
+}
+
+void attachScheduler(b2WorldDef *worldDef) {
+	worldDef->workerCount = scheduler.workerCount;
+	worldDef->enqueueTask = enqueueTask;
+	worldDef->finishTask = finishTask;
+	worldDef->userTaskContext = &scheduler;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <box2d/box2d.h>
+
+// Box2D supports at most 64 workers
+#define MAX_WORKERS 64
+const static int DEFAULT_MAX_WORKERS = 8;
+
+// Worker count used when none is given: one per logical core, up to DEFAULT_MAX_WORKERS
+int defaultWorkerCount(void);
+
+// Starts the thread pool, workerCount includes the thread that steps the world: the
+// simulation thread, or the main thread when running headless
+// A workerCount of 1 runs every Box2D task inline on that thread
+void initScheduler(int workerCount);
+
+// Stops and joins the worker threads
+void destroyScheduler(void);
+
+// Number of workers the scheduler was started with, including the thread that steps the world
+int getWorkerCount(void);
+
+// Hooks the scheduler into a Box2D world definition so the world solves in parallel
+void attachScheduler(b2WorldDef *worldDef);
@@ -0,0 +1,67 @@
+#include <box2d/box2d.h>
+#include <string.h>
+
+#include "game.h"
+#include "snapshot.h"
+#include "store.h"
+#include "arena.h"
+
+extern World world;
+extern Player player;
+
+static BodySnapshot* takeBodies(const ObjectStore *store, Arena *arena) {
+	BodySnapshot *bodies = arenaAlloc(arena, sizeof(BodySnapshot) * (store->count > 0 ? store->count : 1), _Alignof(BodySnapshot));
+
+	for (int i = 0; i < store->count; i++) {
+		bodies[i].transform = b2Body_GetTransform(store->bodyId[i]);
+		bodies[i].linearVelocity = b2Body_GetLinearVelocity(store->bodyId[i]);
+		bodies[i].angularVelocity = b2Body_GetAngularVelocity(store->bodyId[i]);
+	}
+	return bodies;
+}
+
+static void restoreBodies(ObjectStore *store, const BodySnapshot *bodies) {
+	// Nothing is between steps any more
+	store->movedCount = 0;
+
+	for (int i = 0; i < store->count; i++) {
+		const b2BodyId bodyId = store->bodyId[i];
+
+		b2Body_SetTransform(bodyId, bodies[i].transform.p, bodies[i].transform.q);
+		b2Body_SetLinearVelocity(bodyId, bodies[i].linearVelocity);
+		b2Body_SetAngularVelocity(bodyId, bodies[i].angularVelocity);
+		b2Body_SetAwake(bodyId, true);
+
+		// Setting the transform sends no move event, and don't blend from where the body was before the restore
+		store->position[i] = bodies[i].transform.p;
+		store->previousPosition[i] = bodies[i].transform.p;
+	}
+}
+
+void snapshotBodies(LevelSnapshot *snapshot, const ObjectStores *target, Arena *arena) {
+	snapshot->dynamics = takeBodies(&target->dynamics, arena);
+	snapshot->kinematics = takeBodies(&target->kinematics, arena);
+
+	const ObjectStore *kinematics = &target->kinematics;
+	snapshot->paths = arenaAlloc(arena, sizeof(PathState) * (kinematics->count > 0 ? kinematics->count : 1), _Alignof(PathState));
+	memcpy(snapshot->paths, kinematics->pathState, sizeof(PathState) * kinematics->count);
+
+	const ObjectStore *collectibles = &target->collectibles;
+	snapshot->collectibleDraw = arenaAlloc(arena, sizeof(bool) * (collectibles->count > 0 ? collectibles->count : 1), _Alignof(bool));
+	memcpy(snapshot->collectibleDraw, collectibles->draw, sizeof(bool) * collectibles->count);
+}
+
+void snapshotPlayer(LevelSnapshot *snapshot) {
+	snapshot->player = player;
+	snapshot->level = world.level;
+}
+
+void restoreSnapshot(const LevelSnapshot *snapshot) {
+	restoreBodies(&stores.dynamics, snapshot->dynamics);
+	restoreBodies(&stores.kinematics, snapshot->kinematics);
+	memcpy(stores.kinematics.pathState, snapshot->paths, sizeof(PathState) * stores.kinematics.count);
+	memcpy(stores.collectibles.draw, snapshot->collectibleDraw, sizeof(bool) * stores.collectibles.count);
+
+	player = snapshot->player;
+	world.level = snapshot->level;
+}
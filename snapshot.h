@@ -0,0 +1,32 @@
+#pragma once
+#include <box2d/box2d.h>
+#include "game.h"
+#include "store.h"
+#include "arena.h"
+
+// Where a moving body was and how it was moving
+typedef struct BodySnapshot {
+	b2Transform transform;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+} BodySnapshot;
+
+// Everything about a level that changes while it is played. Static bodies never move,
+// so only the dynamic and kinematic bodies are kept
+typedef struct LevelSnapshot {
+	BodySnapshot *dynamics;
+	BodySnapshot *kinematics;
+	bool *collectibleDraw;
+	Player player;
+	PathState *paths; // Where the kinematic platforms are along their paths
+	Level level;
+} LevelSnapshot;
+
+// Captures a level's bodies and collectibles into its arena, valid until the arena is rewound
+void snapshotBodies(LevelSnapshot *snapshot, const ObjectStores *target, Arena *arena);
+
+// Captures the live player and level
+void snapshotPlayer(LevelSnapshot *snapshot);
+
+// Writes a snapshot back into the live world, the world is not rebuilt
+void restoreSnapshot(const LevelSnapshot *snapshot);
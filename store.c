@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "game.h"
+#include "store.h"
+#include "arena.h"
+
+ObjectStores stores;
+
+// Allocate the columns a store of this type uses, they live until the level arena is rewound
+static void allocateStore(ObjectStore *store, ObjectType type, int count, Arena *arena) {
+	memset(store, 0, sizeof(ObjectStore));
+
+	// Keep every column non NULL even when empty so loops don't need to check
+	const int n = count > 0 ? count : 1;
+
+	store->object = arenaAlloc(arena, sizeof(int) * n, _Alignof(int));
+	store->rect = arenaAlloc(arena, sizeof(SDL_FRect) * n, _Alignof(SDL_FRect));
+	store->color = arenaAlloc(arena, sizeof(Color) * n, _Alignof(Color));
+	store->bodyId = arenaAlloc(arena, sizeof(b2BodyId) * n, _Alignof(b2BodyId));
+
+	if (type == DYNAMIC || type == KINEMATIC) {
+		store->position = arenaAlloc(arena, sizeof(b2Vec2) * n, _Alignof(b2Vec2));
+		store->previousPosition = arenaAlloc(arena, sizeof(b2Vec2) * n, _Alignof(b2Vec2));
+		store->moved = arenaAlloc(arena, sizeof(int) * n, _Alignof(int));
+		store->changed[0] = arenaAlloc(arena, sizeof(int) * n, _Alignof(int));
+		store->changed[1] = arenaAlloc(arena, sizeof(int) * n, _Alignof(int));
+		store->changedFrame = arenaCalloc(arena, n, sizeof(Uint64));
+	}
+	if (type == KINEMATIC) {
+		store->path = arenaAlloc(arena, sizeof(KinematicPath) * n, _Alignof(KinematicPath));
+		store->pathState = arenaCalloc(arena, n, sizeof(PathState));
+	}
+	if (type == COLLECTIBLE) store->draw = arenaAlloc(arena, sizeof(bool) * n, _Alignof(bool));
+}
+
+ObjectStore* storeIn(ObjectStores *target, ObjectType type) {
+	switch (type) {
+		case STATIC: return &target->statics;
+		case DYNAMIC: return &target->dynamics;
+		case KINEMATIC: return &target->kinematics;
+		case POOLED: return NULL;
+		case COLLECTIBLE: return &target->collectibles;
+	}
+	return NULL;
+}
+
+ObjectStore* storeFor(ObjectType type) {
+	return storeIn(&stores, type);
+}
+
+void buildObjectStores(ObjectStores *target, Object *objects, int count, Arena *arena) {
+	int counts[4] = {0};
+	for (int i = 0; i < count; i++) counts[objects[i].type]++;
+
+	allocateStore(&target->statics, STATIC, counts[STATIC], arena);
+	allocateStore(&target->dynamics, DYNAMIC, counts[DYNAMIC], arena);
+	allocateStore(&target->kinematics, KINEMATIC, counts[KINEMATIC], arena);
+	allocateStore(&target->collectibles, COLLECTIBLE, counts[COLLECTIBLE], arena);
+
+	// Objects keep their level order within each store
+	for (int i = 0; i < count; i++) {
+		Object *obj = &objects[i];
+		ObjectStore *store = storeIn(target, obj->type);
+		const int slot = store->count++;
+
+		obj->slot = slot;
+		store->object[slot] = i;
+		store->rect[slot] = (SDL_FRect){obj->p.x, obj->p.y, obj->p.w, obj->p.h};
+		store->color[slot] = obj->color;
+		store->bodyId[slot] = b2_nullBodyId;
+
+		if (store->path) buildPath(&store->path[slot], &obj->kinematic);
+		if (store->draw) store->draw[slot] = true;
+	}
+}
+
+void destroyObjectStores() {
+	// The columns themselves go with the level arena
+	memset(&stores, 0, sizeof(ObjectStores));
+}
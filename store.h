@@ -0,0 +1,56 @@
+#pragma once
+#include "game.h"
+#include "arena.h"
+#include "path.h"
+
+// Per frame data for every object of one type, stored as parallel arrays
+// so each loop only pulls in the columns it reads
+// Columns a type never uses are left NULL:
+//   position, previousPosition, moved, changed: dynamic and kinematic
+//   path, pathState: kinematic
+//   draw: collectible
+typedef struct ObjectStore {
+	int count;
+	int *object;      // Index of the level Object each entry was built from
+	SDL_FRect *rect;  // Level position and size in pixels, position only kept up to date for non moving types
+	Color *color;
+	b2BodyId *bodyId; // Null while the object has no body, see stream.h
+	b2Vec2 *position;         // Box2D position after the last step, kept up to date from the body move events
+	b2Vec2 *previousPosition;
+
+	// Slots that moved in the last step. Every other body has previousPosition == position
+	int *moved;
+	int movedCount;
+
+	// Slots whose drawn rect changed in each of the last two snapshotted frames, see takeFrameSnapshot()
+	int *changed[2];
+	int changedCount[2];
+	Uint64 *changedFrame; // Frame each slot was last added to a changed list
+	KinematicPath *path;
+	PathState *pathState;
+	bool *draw;
+} ObjectStore;
+
+// One store per object type
+typedef struct ObjectStores {
+	ObjectStore statics;
+	ObjectStore dynamics;
+	ObjectStore kinematics;
+	ObjectStore collectibles;
+} ObjectStores;
+
+// The stores of the level being played
+extern ObjectStores stores;
+
+// Splits the level objects into per type stores allocated from arena and sets each object's slot
+// The player, objects[0], is always dynamics slot 0
+void buildObjectStores(ObjectStores *target, Object *objects, int count, Arena *arena);
+
+// Forgets the stores of the level being played, their columns are released with the level arena
+void destroyObjectStores(void);
+
+// The store holding objects of a type
+ObjectStore* storeIn(ObjectStores *target, ObjectType type);
+
+// The store holding objects of a type in the level being played
+ObjectStore* storeFor(ObjectType type);
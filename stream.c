@@ -0,0 +1,466 @@
+#include <box2d/box2d.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "stream.h"
+#include "path.h"
+#include "utils.h"
+
+static const ChunkRange emptyRange = {0, 0, -1, -1};
+
+static bool inRange(ChunkRange range, int x, int y) {
+	return x >= range.x0 && x <= range.x1 && y >= range.y0 && y <= range.y1;
+}
+
+static bool rangesOverlap(ChunkRange a, ChunkRange b) {
+	return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+// Whether a static fits in one chunk, and so belongs to its chunk's merged body
+static bool insideOneChunk(ChunkRange covers) {
+	return covers.x0 == covers.x1 && covers.y0 == covers.y1;
+}
+
+static void destroyStreamedBody(ObjectStore *store, int slot) {
+	if (B2_IS_NULL(store->bodyId[slot])) return;
+
+	b2DestroyBody(store->bodyId[slot]);
+	store->bodyId[slot] = b2_nullBodyId;
+}
+
+// Destroys the bodies in the chunks of from that aren't in to, unless the object also covers a chunk in to
+// Objects inside one chunk are skipped if they are merged into the chunk's body
+static void unloadChunks(const CullIndex *chunks, ObjectStore *store, bool merged, ChunkRange from, ChunkRange to) {
+	for (int y = from.y0; y <= from.y1; y++) {
+		for (int x = from.x0; x <= from.x1; x++) {
+			if (inRange(to, x, y)) continue;
+
+			const int cell = y * chunks->columns + x;
+			for (int i = chunks->cellStart[cell]; i < chunks->cellStart[cell + 1]; i++) {
+				const int slot = chunks->items[i].rect;
+
+				ChunkRange covers;
+				cellRange(chunks, store->rect[slot], &covers.x0, &covers.y0, &covers.x1, &covers.y1);
+				if (merged && insideOneChunk(covers)) continue;
+				if (!rangesOverlap(covers, to)) destroyStreamedBody(store, slot);
+			}
+		}
+	}
+}
+
+// Creates the bodies in the chunks of to that weren't in from
+static void loadChunks(const CullIndex *chunks, ObjectStore *store, bool merged, b2WorldId worldId, ObjectStores *target,
+	Object *objects, ChunkRange from, ChunkRange to) {
+	for (int y = to.y0; y <= to.y1; y++) {
+		for (int x = to.x0; x <= to.x1; x++) {
+			if (inRange(from, x, y)) continue;
+
+			const int cell = y * chunks->columns + x;
+			for (int i = chunks->cellStart[cell]; i < chunks->cellStart[cell + 1]; i++) {
+				const int slot = chunks->items[i].rect;
+
+				// Already made from another chunk, or a coin that was picked up
+				if (B2_IS_NON_NULL(store->bodyId[slot])) continue;
+				if (store->draw != NULL && !store->draw[slot]) continue;
+
+				ChunkRange covers;
+				cellRange(chunks, store->rect[slot], &covers.x0, &covers.y0, &covers.x1, &covers.y1);
+				if (merged && insideOneChunk(covers)) continue;
+
+				createObjectBody(worldId, target, &objects[store->object[slot]]);
+			}
+		}
+	}
+}
+
+// The chunk a body's center is in
+static int chunkAt(const Streamer *streamer, b2Vec2 position, int *x, int *y) {
+	const b2Vec2 center = Box2DXYToSDL(position.x, position.y);
+
+	int unused;
+	cellRange(&streamer->statics, (SDL_FRect){center.x, center.y, 0, 0}, x, y, &unused, &unused);
+	return *y * streamer->statics.columns + *x;
+}
+
+static void fileDynamic(Streamer *streamer, int slot, int cell) {
+	const int first = streamer->chunkDynamics[cell];
+
+	streamer->dynamicChunk[slot] = cell;
+	streamer->previousDynamic[slot] = -1;
+	streamer->nextDynamic[slot] = first;
+	if (first >= 0) streamer->previousDynamic[first] = slot;
+	streamer->chunkDynamics[cell] = slot;
+}
+
+static void unfileDynamic(Streamer *streamer, int slot) {
+	const int previous = streamer->previousDynamic[slot];
+	const int next = streamer->nextDynamic[slot];
+
+	if (previous >= 0) streamer->nextDynamic[previous] = next;
+	else streamer->chunkDynamics[streamer->dynamicChunk[slot]] = next;
+	if (next >= 0) streamer->previousDynamic[next] = previous;
+}
+
+// Enables or disables the dynamic bodies filed under a chunk
+static void enableChunkDynamics(Streamer *streamer, ObjectStore *dynamics, int cell, bool enable) {
+	for (int slot = streamer->chunkDynamics[cell]; slot >= 0; slot = streamer->nextDynamic[slot]) {
+		const b2BodyId bodyId = dynamics->bodyId[slot];
+		if (enable && !b2Body_IsEnabled(bodyId)) b2Body_Enable(bodyId);
+		if (!enable && b2Body_IsEnabled(bodyId)) b2Body_Disable(bodyId);
+	}
+}
+
+void moveStreamedBody(Streamer *streamer, ObjectStore *dynamics, int slot) {
+	if (streamer->dynamicChunk[slot] < 0) return;
+
+	int x, y;
+	const int cell = chunkAt(streamer, dynamics->position[slot], &x, &y);
+	if (cell == streamer->dynamicChunk[slot]) return;
+
+	unfileDynamic(streamer, slot);
+	fileDynamic(streamer, slot, cell);
+
+	// It would fall through the floor once that is streamed out, so it waits, disabled,
+	// until its chunk is back in range
+	if (!inRange(streamer->active, x, y)) b2Body_Disable(dynamics->bodyId[slot]);
+}
+
+// Stops a platform, remembering when so it can be caught up
+static void parkPlatform(Streamer *streamer, ObjectStore *kinematics, int slot) {
+	const int index = streamer->platformIndex[slot];
+	if (index < 0) return;
+
+	b2Body_Disable(kinematics->bodyId[slot]);
+	streamer->parkedStep[slot] = streamer->step;
+
+	const int last = streamer->activePlatforms[--streamer->activePlatformCount];
+	streamer->activePlatforms[index] = last;
+	streamer->platformIndex[last] = index;
+	streamer->platformIndex[slot] = -1;
+}
+
+// Moves a platform to where its path would have taken it while it was parked, and starts it again
+static void unparkPlatform(Streamer *streamer, ObjectStore *kinematics, int slot) {
+	if (streamer->platformIndex[slot] >= 0) return;
+
+	const b2BodyId bodyId = kinematics->bodyId[slot];
+	const KinematicPath *path = &kinematics->path[slot];
+	PathState *state = &kinematics->pathState[slot];
+
+	if (path->count > 0 && streamer->step != streamer->parkedStep[slot]) {
+		skipPath(path, state, (double)(streamer->step - streamer->parkedStep[slot]) * TIME_STEP);
+
+		const SDL_FRect r = kinematics->rect[slot];
+		const b2Vec2 position = b2Add(SDLXYToBox2D(r.x + r.w / 2, r.y + r.h / 2), pathOffset(path, state));
+		b2Body_SetTransform(bodyId, position, (b2Rot){1, 0});
+		kinematics->position[slot] = kinematics->previousPosition[slot] = position;
+		markChanged(kinematics, slot);
+
+		// The next advancePaths() gives it its velocity
+		b2Body_SetLinearVelocity(bodyId, (b2Vec2){0, 0});
+		state->velocity = (b2Vec2){0, 0};
+	}
+
+	b2Body_Enable(bodyId);
+	streamer->platformIndex[slot] = streamer->activePlatformCount;
+	streamer->activePlatforms[streamer->activePlatformCount++] = slot;
+}
+
+// Parks the platforms in the chunks of from that aren't in to, unless their path also covers a chunk in to
+static void parkPlatforms(Streamer *streamer, ObjectStore *kinematics, ChunkRange from, ChunkRange to) {
+	const CullIndex *chunks = &streamer->platforms;
+
+	for (int y = from.y0; y <= from.y1; y++) {
+		for (int x = from.x0; x <= from.x1; x++) {
+			if (inRange(to, x, y)) continue;
+
+			const int cell = y * chunks->columns + x;
+			for (int i = chunks->cellStart[cell]; i < chunks->cellStart[cell + 1]; i++) {
+				const int slot = chunks->items[i].rect;
+
+				ChunkRange covers;
+				cellRange(chunks, streamer->platformBounds[slot], &covers.x0, &covers.y0, &covers.x1, &covers.y1);
+				if (!rangesOverlap(covers, to)) parkPlatform(streamer, kinematics, slot);
+			}
+		}
+	}
+}
+
+// Starts the platforms in the chunks of to that weren't in from
+static void unparkPlatforms(Streamer *streamer, ObjectStore *kinematics, ChunkRange from, ChunkRange to) {
+	const CullIndex *chunks = &streamer->platforms;
+
+	for (int y = to.y0; y <= to.y1; y++) {
+		for (int x = to.x0; x <= to.x1; x++) {
+			if (inRange(from, x, y)) continue;
+
+			const int cell = y * chunks->columns + x;
+			for (int i = chunks->cellStart[cell]; i < chunks->cellStart[cell + 1]; i++) unparkPlatform(streamer, kinematics, chunks->items[i].rect);
+		}
+	}
+}
+
+// Everywhere a platform goes, its rectangle moved to every waypoint of its path
+static SDL_FRect platformBounds(SDL_FRect rect, const KinematicPath *path) {
+	float x = 0, y = 0;
+	float left = 0, top = 0, right = 0, bottom = 0;
+
+	for (int i = 0; i < path->count; i++) {
+		// Box2D's y goes up and SDL's down
+		x += meterToPixel(path->segments[i].delta.x);
+		y -= meterToPixel(path->segments[i].delta.y);
+
+		if (x < left) left = x;
+		if (x > right) right = x;
+		if (y < top) top = y;
+		if (y > bottom) bottom = y;
+	}
+
+	return (SDL_FRect){rect.x + left, rect.y + top, rect.w + right - left, rect.h + bottom - top};
+}
+
+// Orders pieces into rows, left to right
+static int compareRows(const void *a, const void *b) {
+	const SDL_FRect *x = &((const StaticPiece*)a)->rect;
+	const SDL_FRect *y = &((const StaticPiece*)b)->rect;
+
+	if (x->y != y->y) return x->y < y->y ? -1 : 1;
+	if (x->h != y->h) return x->h < y->h ? -1 : 1;
+	if (x->x != y->x) return x->x < y->x ? -1 : 1;
+	return 0;
+}
+
+// Orders pieces into columns, top to bottom
+static int compareColumns(const void *a, const void *b) {
+	const SDL_FRect *x = &((const StaticPiece*)a)->rect;
+	const SDL_FRect *y = &((const StaticPiece*)b)->rect;
+
+	if (x->x != y->x) return x->x < y->x ? -1 : 1;
+	if (x->w != y->w) return x->w < y->w ? -1 : 1;
+	if (x->y != y->y) return x->y < y->y ? -1 : 1;
+	return 0;
+}
+
+// Merges pieces that share a whole edge, first along rows then down columns
+// Returns how many pieces are left at the start of the array
+static int mergePieces(StaticPiece *pieces, int count) {
+	if (count < 2) return count;
+
+	// Same top and height, and the next one starts where this one ends
+	qsort(pieces, count, sizeof(StaticPiece), compareRows);
+	int merged = 1;
+	for (int i = 1; i < count; i++) {
+		StaticPiece *last = &pieces[merged - 1];
+		const SDL_FRect r = pieces[i].rect;
+
+		if (last->rect.y == r.y && last->rect.h == r.h && last->rect.x + last->rect.w == r.x) {
+			last->rect.w += r.w;
+		} else {
+			pieces[merged++] = pieces[i];
+		}
+	}
+	count = merged;
+
+	// Same left side and width, stacked
+	qsort(pieces, count, sizeof(StaticPiece), compareColumns);
+	merged = 1;
+	for (int i = 1; i < count; i++) {
+		StaticPiece *last = &pieces[merged - 1];
+		const SDL_FRect r = pieces[i].rect;
+
+		if (last->rect.x == r.x && last->rect.w == r.w && last->rect.y + last->rect.h == r.y) {
+			last->rect.h += r.h;
+		} else {
+			pieces[merged++] = pieces[i];
+		}
+	}
+	return merged;
+}
+
+void buildStreamer(Streamer *streamer, const ObjectStores *target, float levelWidth, float levelHeight, Arena *arena) {
+	CullIndex *chunks = &streamer->statics;
+	buildCullIndex(chunks, target->statics.rect, target->statics.count, levelWidth, levelHeight, STREAM_CHUNK_SIZE, arena);
+	buildCullIndex(&streamer->collectibles, target->collectibles.rect, target->collectibles.count, levelWidth, levelHeight, STREAM_CHUNK_SIZE, arena);
+	streamer->active = emptyRange;
+	streamer->loaded = emptyRange;
+	streamer->step = 0;
+
+	const int cells = chunks->columns * chunks->rows;
+	const int count = target->statics.count;
+	streamer->pieceStart = arenaAlloc(arena, sizeof(int) * (cells + 1), _Alignof(int));
+	streamer->pieces = arenaAlloc(arena, sizeof(StaticPiece) * (count > 0 ? count : 1), _Alignof(StaticPiece));
+	streamer->chunkBodies = arenaAlloc(arena, sizeof(b2BodyId) * cells, _Alignof(b2BodyId));
+
+	// Each chunk's statics that fit inside it, merged in place
+	int pieces = 0;
+	for (int cell = 0; cell < cells; cell++) {
+		const int start = pieces;
+		streamer->pieceStart[cell] = start;
+		streamer->chunkBodies[cell] = b2_nullBodyId;
+
+		for (int i = chunks->cellStart[cell]; i < chunks->cellStart[cell + 1]; i++) {
+			const int slot = chunks->items[i].rect;
+			const SDL_FRect rect = target->statics.rect[slot];
+
+			ChunkRange covers;
+			cellRange(chunks, rect, &covers.x0, &covers.y0, &covers.x1, &covers.y1);
+			if (insideOneChunk(covers)) streamer->pieces[pieces++] = (StaticPiece){rect, slot};
+		}
+
+		pieces = start + mergePieces(&streamer->pieces[start], pieces - start);
+	}
+	streamer->pieceStart[cells] = pieces;
+
+	// Dynamic bodies by where they start, the player isn't streamed
+	const ObjectStore *dynamics = &target->dynamics;
+	const int dynamicCount = dynamics->count > 0 ? dynamics->count : 1;
+	streamer->chunkDynamics = arenaAlloc(arena, sizeof(int) * cells, _Alignof(int));
+	streamer->dynamicChunk = arenaAlloc(arena, sizeof(int) * dynamicCount, _Alignof(int));
+	streamer->nextDynamic = arenaAlloc(arena, sizeof(int) * dynamicCount, _Alignof(int));
+	streamer->previousDynamic = arenaAlloc(arena, sizeof(int) * dynamicCount, _Alignof(int));
+
+	for (int cell = 0; cell < cells; cell++) streamer->chunkDynamics[cell] = -1;
+	if (dynamics->count > 0) streamer->dynamicChunk[0] = -1;
+	for (int i = 1; i < dynamics->count; i++) {
+		int x, y;
+		fileDynamic(streamer, i, chunkAt(streamer, dynamics->position[i], &x, &y));
+	}
+
+	// Platforms by everywhere their path takes them, all parked until the first update
+	const ObjectStore *kinematics = &target->kinematics;
+	const int platformCount = kinematics->count > 0 ? kinematics->count : 1;
+	streamer->platformBounds = arenaAlloc(arena, sizeof(SDL_FRect) * platformCount, _Alignof(SDL_FRect));
+	streamer->activePlatforms = arenaAlloc(arena, sizeof(int) * platformCount, _Alignof(int));
+	streamer->platformIndex = arenaAlloc(arena, sizeof(int) * platformCount, _Alignof(int));
+	streamer->parkedStep = arenaCalloc(arena, platformCount, sizeof(Uint64));
+	streamer->activePlatformCount = 0;
+
+	for (int i = 0; i < kinematics->count; i++) {
+		streamer->platformBounds[i] = platformBounds(kinematics->rect[i], &kinematics->path[i]);
+		streamer->platformIndex[i] = -1;
+	}
+	buildCullIndex(&streamer->platforms, streamer->platformBounds, kinematics->count, levelWidth, levelHeight, STREAM_CHUNK_SIZE, arena);
+}
+
+// Creates one static body holding a box for each of a chunk's merged pieces
+static void createChunkBody(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, int cell) {
+	if (streamer->pieceStart[cell] == streamer->pieceStart[cell + 1]) return;
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	const b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
+
+	for (int i = streamer->pieceStart[cell]; i < streamer->pieceStart[cell + 1]; i++) {
+		const StaticPiece *piece = &streamer->pieces[i];
+		const SDL_FRect r = piece->rect;
+
+		// Shapes point back at the first object of the piece, like a lone static would
+		b2ShapeDef shapeDef = b2DefaultShapeDef();
+		shapeDef.density = 1.0f;
+		shapeDef.friction = 0.5f;
+		shapeDef.userData = &objects[target->statics.object[piece->slot]];
+
+		const b2Vec2 center = SDLXYToBox2D(r.x + r.w / 2, r.y + r.h / 2);
+		const b2Vec2 size = {pixelToMeter(r.w / 2), pixelToMeter(r.h / 2)};
+		const b2Polygon box = b2MakeOffsetBox(size.x, size.y, center, (b2Rot){1, 0});
+		b2CreatePolygonShape(bodyId, &shapeDef, &box);
+	}
+
+	streamer->chunkBodies[cell] = bodyId;
+}
+
+static void destroyChunkBody(Streamer *streamer, int cell) {
+	if (B2_IS_NULL(streamer->chunkBodies[cell])) return;
+
+	b2DestroyBody(streamer->chunkBodies[cell]);
+	streamer->chunkBodies[cell] = b2_nullBodyId;
+}
+
+// The chunks within radius of (x, y), clamped to the level
+static ChunkRange aroundChunk(const Streamer *streamer, int x, int y, int radius) {
+	ChunkRange range = {x - radius, y - radius, x + radius, y + radius};
+	if (range.x0 < 0) range.x0 = 0;
+	if (range.y0 < 0) range.y0 = 0;
+	if (range.x1 >= streamer->statics.columns) range.x1 = streamer->statics.columns - 1;
+	if (range.y1 >= streamer->statics.rows) range.y1 = streamer->statics.rows - 1;
+	return range;
+}
+
+// Moves the active range to to and the loaded range to loadTo, statics and collectibles share the same chunks
+static void moveActiveRange(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, ChunkRange to, ChunkRange loadTo) {
+	const ChunkRange from = streamer->active;
+	const ChunkRange loadFrom = streamer->loaded;
+	const int columns = streamer->statics.columns;
+
+	unloadChunks(&streamer->statics, &target->statics, true, loadFrom, loadTo);
+	unloadChunks(&streamer->collectibles, &target->collectibles, false, loadFrom, loadTo);
+	loadChunks(&streamer->statics, &target->statics, true, worldId, target, objects, loadFrom, loadTo);
+	loadChunks(&streamer->collectibles, &target->collectibles, false, worldId, target, objects, loadFrom, loadTo);
+
+	// Merged statics come and go with their chunk
+	for (int y = loadFrom.y0; y <= loadFrom.y1; y++) {
+		for (int x = loadFrom.x0; x <= loadFrom.x1; x++) {
+			if (!inRange(loadTo, x, y)) destroyChunkBody(streamer, y * columns + x);
+		}
+	}
+	for (int y = loadTo.y0; y <= loadTo.y1; y++) {
+		for (int x = loadTo.x0; x <= loadTo.x1; x++) {
+			if (!inRange(loadFrom, x, y)) createChunkBody(streamer, worldId, target, objects, y * columns + x);
+		}
+	}
+
+	parkPlatforms(streamer, &target->kinematics, from, to);
+	unparkPlatforms(streamer, &target->kinematics, from, to);
+
+	// Other dynamic bodies would fall through the floor once it is streamed out, so they
+	// wait, disabled, until their chunk is back
+	for (int y = from.y0; y <= from.y1; y++) {
+		for (int x = from.x0; x <= from.x1; x++) {
+			if (!inRange(to, x, y)) enableChunkDynamics(streamer, &target->dynamics, y * columns + x, false);
+		}
+	}
+	for (int y = to.y0; y <= to.y1; y++) {
+		for (int x = to.x0; x <= to.x1; x++) {
+			if (!inRange(from, x, y)) enableChunkDynamics(streamer, &target->dynamics, y * columns + x, true);
+		}
+	}
+
+	streamer->active = to;
+	streamer->loaded = loadTo;
+}
+
+void updateStreamer(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, float x, float y) {
+	int cx, cy, unused;
+	cellRange(&streamer->statics, (SDL_FRect){x, y, 0, 0}, &cx, &cy, &unused, &unused);
+
+	// Only move once the player is over a chunk away from the center, so walking
+	// back and forth over a chunk edge doesn't create and destroy bodies every step
+	const bool loaded = streamer->active.x1 >= streamer->active.x0;
+	if (!loaded || abs(cx - streamer->centerX) > 1 || abs(cy - streamer->centerY) > 1) {
+		// Statics are loaded a chunk further out, so a body at the edge of the active
+		// range still has the ground it overlaps
+		const ChunkRange to = aroundChunk(streamer, cx, cy, STREAM_RADIUS);
+		const ChunkRange loadTo = aroundChunk(streamer, cx, cy, STREAM_RADIUS + 1);
+		moveActiveRange(streamer, worldId, target, objects, to, loadTo);
+		streamer->centerX = cx;
+		streamer->centerY = cy;
+	}
+
+	// A step passes between updates, parked platforms are caught up by how many did
+	streamer->step++;
+}
+
+void resetStreamer(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, float x, float y) {
+	moveActiveRange(streamer, worldId, target, objects, emptyRange, emptyRange);
+
+	// The bodies were put back where they started, so file them there again. Platforms
+	// were put back on their path too, with no time to catch up on
+	ObjectStore *dynamics = &target->dynamics;
+	for (int i = 1; i < dynamics->count; i++) {
+		int cx, cy;
+		unfileDynamic(streamer, i);
+		fileDynamic(streamer, i, chunkAt(streamer, dynamics->position[i], &cx, &cy));
+	}
+	for (int i = 0; i < target->kinematics.count; i++) streamer->parkedStep[i] = streamer->step;
+
+	updateStreamer(streamer, worldId, target, objects, x, y);
+}
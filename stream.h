@@ -0,0 +1,80 @@
+#pragma once
+#include <box2d/box2d.h>
+#include "game.h"
+#include "store.h"
+#include "cull.h"
+#include "arena.h"
+
+// Size of a streaming chunk in pixels
+const static float STREAM_CHUNK_SIZE = 512.0f;
+
+// Chunks around the player's chunk whose moving bodies are enabled, statics are loaded one further
+const static int STREAM_RADIUS = 3;
+
+// An inclusive range of chunks, empty when x1 < x0
+typedef struct ChunkRange {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+} ChunkRange;
+
+// A piece of static geometry merged from touching static rectangles inside one chunk
+typedef struct StaticPiece {
+	SDL_FRect rect;
+	int slot; // Statics slot of the object the piece's shapes point back at
+} StaticPiece;
+
+// Creates and destroys the bodies of static objects and collectibles by chunk, so only the
+// part of the level around the player is in Box2D. Objects are filed under every chunk
+// they cover and have a body while any of those chunks is in range. Collected coins only
+// keep their draw flag while out of range and aren't given a body again.
+// Statics that fit inside one chunk are merged into pieces on one static body per chunk
+// Moving bodies always exist but are disabled while out of range, and only the chunks that
+// enter or leave the range are looked at. Dynamic bodies other than the player are filed
+// under the chunk their center is in and filed again as they move. Platforms are filed
+// under every chunk their whole path covers, and are caught up along their path when
+// they are enabled again
+typedef struct Streamer {
+	CullIndex statics;
+	CullIndex collectibles;
+	CullIndex platforms;   // Kinematics, by the bounds of their path
+	int *pieceStart;       // Where each chunk's pieces start in pieces, columns * rows + 1 entries
+	StaticPiece *pieces;
+	b2BodyId *chunkBodies; // The static body of each chunk, null when it isn't loaded
+	int *chunkDynamics;    // First dynamic body filed under each chunk, -1 if none
+	int *dynamicChunk;     // Chunk each dynamic body is filed under, -1 for the player
+	int *nextDynamic;      // Next and previous dynamic body in the same chunk, -1 at the ends
+	int *previousDynamic;
+	SDL_FRect *platformBounds; // Everywhere each platform's path takes it, in level pixels
+	int *activePlatforms;      // Platforms with an enabled body, the only ones moved along their paths
+	int activePlatformCount;
+	int *platformIndex;        // Where each platform is in activePlatforms, -1 while out of range
+	Uint64 *parkedStep;        // Step each platform went out of range on
+	Uint64 step;               // Steps the streamer has been updated for
+	ChunkRange active; // Chunks whose moving bodies are enabled
+	ChunkRange loaded; // Chunks whose statics and collectibles have bodies, a chunk wider than active
+	int centerX;       // Chunk the active range was centered on
+	int centerY;
+} Streamer;
+
+// Files a level's objects under chunks and merges the statics of each chunk in arena,
+// no bodies are created yet. Moving bodies other than the player are made disabled, see createObjectBody()
+void buildStreamer(Streamer *streamer, const ObjectStores *target, float levelWidth, float levelHeight, Arena *arena);
+
+// Moves the active range when the player at (x, y) in level pixels has moved more than a
+// chunk from its center, creating and destroying the bodies of the chunks that change
+// Called once every step
+void updateStreamer(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, float x, float y);
+
+// Destroys every streamed body and creates them again around (x, y), for after a restore
+void resetStreamer(Streamer *streamer, b2WorldId worldId, ObjectStores *target, Object *objects, float x, float y);
+
+// Files a dynamic body again after it moved, disabling it if it left the active range
+void moveStreamedBody(Streamer *streamer, ObjectStore *dynamics, int slot);
+
+// Creates the body and shapes for an object and fills in its store slot, defined in game.c
+void createObjectBody(b2WorldId worldId, ObjectStores *target, Object *obj);
+
+// Remembers that a body's drawn rect changed this frame so the next snapshot redraws it, defined in game.c
+void markChanged(ObjectStore *store, int slot);
@@ -0,0 +1,159 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_render.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "tiles.h"
+#include "render.h"
+
+void initStaticTiles(StaticTiles *tiles, float levelWidth, float levelHeight) {
+	destroyStaticTiles(tiles);
+
+	tiles->columns = ceilf(levelWidth / STATIC_TILE_SIZE);
+	tiles->rows = ceilf(levelHeight / STATIC_TILE_SIZE);
+	if (tiles->columns < 1) tiles->columns = 1;
+	if (tiles->rows < 1) tiles->rows = 1;
+
+	tiles->residentCount = 0;
+	tiles->frame = 0;
+	tiles->textures = calloc(tiles->columns * tiles->rows, sizeof(SDL_Texture*));
+	if (tiles->textures == NULL) {
+		SDL_Log("Couldn't allocate %d static tiles", tiles->columns * tiles->rows);
+		exit(1);
+	}
+}
+
+// Queues the statics overlapping area, moved so area's corner is at (x, y)
+static void queueStatics(CullIndex *cull, const ObjectStore *statics, SDL_FRect area, float x, float y, bool opaque) {
+	const int visible = cullRects(cull, statics->rect, area);
+
+	for (int i = 0; i < visible; i++) {
+		const int slot = cull->visible[i];
+		SDL_FRect rect = statics->rect[slot];
+		rect.x += x - area.x;
+		rect.y += y - area.y;
+
+		Color color = statics->color[slot];
+		if (opaque) color.a = SDL_ALPHA_OPAQUE;
+		renderRectangle(&rect, color);
+	}
+}
+
+// Draws the statics of one tile into a new texture, returns NULL if it couldn't be made
+static SDL_Texture* buildTile(SDL_Renderer *renderer, CullIndex *cull, const ObjectStore *statics, SDL_FRect area) {
+	SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, STATIC_TILE_SIZE, STATIC_TILE_SIZE);
+	if (texture == NULL) {
+		SDL_Log("Couldn't create static tile texture: %s", SDL_GetError());
+		return NULL;
+	}
+
+	// Anything already queued belongs on the screen, not in the tile
+	flushRectangles(renderer);
+
+	SDL_Texture *screen = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, texture);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
+	SDL_RenderClear(renderer);
+
+	// Statics were drawn with blending off, so they always covered what was under them.
+	// The tile is blended over the background, so keep them opaque inside it
+	queueStatics(cull, statics, area, 0, 0, true);
+	flushRectangles(renderer);
+	SDL_SetRenderTarget(renderer, screen);
+
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+	return texture;
+}
+
+// Finds room for one more texture, evicting the tile drawn longest ago
+// Returns the resident entry to use, or -1 if every tile was drawn this frame
+static int residentEntry(StaticTiles *tiles) {
+	if (tiles->residentCount < STATIC_TILE_CACHE) return tiles->residentCount++;
+
+	int oldest = 0;
+	for (int i = 1; i < STATIC_TILE_CACHE; i++) {
+		if (tiles->lastDrawn[i] < tiles->lastDrawn[oldest]) oldest = i;
+	}
+	if (tiles->lastDrawn[oldest] == tiles->frame) return -1;
+
+	SDL_Texture **evicted = &tiles->textures[tiles->resident[oldest]];
+	SDL_DestroyTexture(*evicted);
+	*evicted = NULL;
+	return oldest;
+}
+
+// Marks a resident tile as drawn this frame
+static void touchTile(StaticTiles *tiles, int tile) {
+	for (int i = 0; i < tiles->residentCount; i++) {
+		if (tiles->resident[i] != tile) continue;
+		tiles->lastDrawn[i] = tiles->frame;
+		return;
+	}
+}
+
+static int clampTile(float position, int count) {
+	int tile = floorf(position / STATIC_TILE_SIZE);
+	if (tile < 0) return 0;
+	if (tile >= count) return count - 1;
+	return tile;
+}
+
+void drawStaticTiles(StaticTiles *tiles, SDL_Renderer *renderer, CullIndex *cull, const ObjectStore *statics, SDL_FRect view, float xoffset, float yoffset) {
+	const int x0 = clampTile(view.x, tiles->columns);
+	const int y0 = clampTile(view.y, tiles->rows);
+	const int x1 = clampTile(view.x + view.w, tiles->columns);
+	const int y1 = clampTile(view.y + view.h, tiles->rows);
+	tiles->frame++;
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			const int tile = y * tiles->columns + x;
+			SDL_Texture **texture = &tiles->textures[tile];
+			const SDL_FRect area = {x * STATIC_TILE_SIZE, y * STATIC_TILE_SIZE, STATIC_TILE_SIZE, STATIC_TILE_SIZE};
+
+			if (*texture != NULL) {
+				touchTile(tiles, tile);
+			} else {
+				const int entry = residentEntry(tiles);
+				if (entry >= 0) *texture = buildTile(renderer, cull, statics, area);
+
+				if (*texture != NULL) {
+					tiles->resident[entry] = tile;
+					tiles->lastDrawn[entry] = tiles->frame;
+				} else if (entry >= 0) {
+					// Give the entry back, it has nothing in it
+					tiles->resident[entry] = tiles->resident[--tiles->residentCount];
+					tiles->lastDrawn[entry] = tiles->lastDrawn[tiles->residentCount];
+				}
+			}
+
+			// Without a texture, draw the tile's statics straight to the screen like before
+			if (*texture == NULL) {
+				queueStatics(cull, statics, area, area.x + xoffset, area.y + yoffset, false);
+				continue;
+			}
+
+			const SDL_FRect destination = {area.x + xoffset, area.y + yoffset, area.w, area.h};
+			SDL_RenderTexture(renderer, *texture, NULL, &destination);
+		}
+	}
+}
+
+void invalidateStaticTiles(StaticTiles *tiles) {
+	if (tiles->textures == NULL) return;
+
+	for (int i = 0; i < tiles->residentCount; i++) {
+		SDL_Texture **texture = &tiles->textures[tiles->resident[i]];
+		SDL_DestroyTexture(*texture);
+		*texture = NULL;
+	}
+	tiles->residentCount = 0;
+}
+
+void destroyStaticTiles(StaticTiles *tiles) {
+	invalidateStaticTiles(tiles);
+	free(tiles->textures);
+	tiles->textures = NULL;
+	tiles->columns = tiles->rows = 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <SDL3/SDL_render.h>
+#include "game.h"
+#include "store.h"
+#include "cull.h"
+
+// Size of a static tile texture in pixels
+const static int STATIC_TILE_SIZE = 512;
+
+// Most tile textures kept at once, each is about 1 MiB. The screen needs at most 6
+#define STATIC_TILE_CACHE 16
+
+// The level's static objects drawn into a grid of textures, each tile is drawn when it
+// comes into view and then only copied to the screen. Only the STATIC_TILE_CACHE tiles
+// drawn most recently keep their textures, so big levels don't fill video memory
+typedef struct StaticTiles {
+	int columns;
+	int rows;
+	SDL_Texture **textures; // NULL until the tile is seen, and again once it is evicted
+	int resident[STATIC_TILE_CACHE];    // Tiles that have a texture
+	Uint64 lastDrawn[STATIC_TILE_CACHE]; // Frame each resident tile was last drawn on
+	int residentCount;
+	Uint64 frame;
+} StaticTiles;
+
+// Sizes the grid for a level, no textures are made yet
+void initStaticTiles(StaticTiles *tiles, float levelWidth, float levelHeight);
+
+// Draws the tiles under view (in level pixels) at the camera offset, building any not drawn yet
+// and evicting the least recently drawn tiles to make room
+// Statics are looked up through cull, so its visible list is overwritten
+void drawStaticTiles(StaticTiles *tiles, SDL_Renderer *renderer, CullIndex *cull, const ObjectStore *statics, SDL_FRect view, float xoffset, float yoffset);
+
+// Throws away the textures so they are drawn again, for when the renderer loses its targets
+void invalidateStaticTiles(StaticTiles *tiles);
+
+// Destroys the textures and the grid, must be called before the renderer is destroyed
+void destroyStaticTiles(StaticTiles *tiles);
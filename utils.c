@@ -1,6 +1,10 @@
 #include "game.h"
 #include "utils.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 float pixelToMeter(const float value) {
 	return value / PIXELS_PER_METER;
 }
@@ -9,15 +13,59 @@ float meterToPixel(const float value) {
 	return value * PIXELS_PER_METER;
 }
 
-b2Vec2 box2DToSDL(b2Vec2 vector, Object *object) {
-	vector.x = meterToPixel(vector.x) - object->p.w / 2;
-	vector.y = HEIGHT - meterToPixel(vector.y) - object->p.h / 2;
+b2Vec2 box2DToSDL(b2Vec2 vector, const SDL_FRect *rect) {
+	vector.x = meterToPixel(vector.x) - rect->w / 2;
+	vector.y = HEIGHT - meterToPixel(vector.y) - rect->h / 2;
 	return vector;
 }
 
-b2Vec2 SDLToBox2D(b2Vec2 vector, Object *object) {
-	vector.x = pixelToMeter(vector.x + object->p.w / 2); 
-	vector.y = pixelToMeter(HEIGHT - vector.y + object->p.h / 2);
+// One body of bodiesToScreen(), also finishes off the odd body the SSE loop leaves
+static SDL_FRect bodyToScreen(b2Vec2 previous, b2Vec2 current, const SDL_FRect *rect, float alpha, float xoffset, float yoffset) {
+	const b2Vec2 position = box2DToSDL(b2Lerp(previous, current, alpha), rect);
+	return (SDL_FRect){position.x + xoffset, position.y + yoffset, rect->w, rect->h};
+}
+
+void bodiesToScreen(const b2Vec2 *previous, const b2Vec2 *current, const SDL_FRect *rects, int count, float alpha, float xoffset, float yoffset, SDL_FRect *out) {
+	int i = 0;
+
+#if defined(__SSE2__)
+	// Two bodies per register: x0 y0 x1 y1
+	const __m128 blend = _mm_set1_ps(alpha);
+	const __m128 scale = _mm_setr_ps(PIXELS_PER_METER, -PIXELS_PER_METER, PIXELS_PER_METER, -PIXELS_PER_METER);
+	const __m128 offset = _mm_setr_ps(xoffset, HEIGHT + yoffset, xoffset, HEIGHT + yoffset);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (; i + 2 <= count; i += 2) {
+		const __m128 from = _mm_loadu_ps(&previous[i].x);
+		const __m128 to = _mm_loadu_ps(&current[i].x);
+
+		// Blend, then turn meters with y up into pixels with y down, camera included
+		const __m128 position = _mm_add_ps(_mm_mul_ps(_mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), blend)), scale), offset);
+
+		// Rects are x y w h, center each body on its size and keep the size
+		const __m128 first = _mm_loadu_ps(&rects[i].x);
+		const __m128 second = _mm_loadu_ps(&rects[i + 1].x);
+		const __m128 firstHalf = _mm_mul_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(3, 2, 3, 2)), half);
+		const __m128 secondHalf = _mm_mul_ps(_mm_shuffle_ps(second, second, _MM_SHUFFLE(3, 2, 3, 2)), half);
+
+		_mm_storeu_ps(&out[i].x, _mm_shuffle_ps(_mm_sub_ps(position, firstHalf), first, _MM_SHUFFLE(3, 2, 1, 0)));
+		_mm_storeu_ps(&out[i + 1].x, _mm_shuffle_ps(_mm_sub_ps(position, secondHalf), second, _MM_SHUFFLE(3, 2, 3, 2)));
+	}
+#endif
+
+	for (; i < count; i++) out[i] = bodyToScreen(previous[i], current[i], &rects[i], alpha, xoffset, yoffset);
+}
+
+void bodiesToScreenAt(const b2Vec2 *previous, const b2Vec2 *current, const SDL_FRect *rects, const int *slots, int count, float alpha, float xoffset, float yoffset, SDL_FRect *out) {
+	for (int i = 0; i < count; i++) {
+		const int slot = slots[i];
+		out[slot] = bodyToScreen(previous[slot], current[slot], &rects[slot], alpha, xoffset, yoffset);
+	}
+}
+
+b2Vec2 SDLToBox2D(b2Vec2 vector, const SDL_FRect *rect) {
+	vector.x = pixelToMeter(vector.x + rect->w / 2); 
+	vector.y = pixelToMeter(HEIGHT - vector.y + rect->h / 2);
 	return vector;
 }
 
@@ -8,11 +8,19 @@ float pixelToMeter(const float value);
 // Convert box2d meter unit to SDL pixel unit
 float meterToPixel(const float value);
 
-// Converts Box2d posistion to SDL Object position
-b2Vec2 box2DToSDL(b2Vec2 vector, Object *object);
+// Converts Box2d posistion to SDL position of a rectangle with the given size
+b2Vec2 box2DToSDL(b2Vec2 vector, const SDL_FRect *rect);
 
-// Converts SDL Object position to Box2d Position
-b2Vec2 SDLToBox2D(b2Vec2 vector, Object *object);
+// Converts a whole array of bodies to screen rectangles: blends each from previous to current by
+// alpha, converts to SDL with the size from rects and adds the camera offset
+// Uses SSE two bodies at a time when the build has it
+void bodiesToScreen(const b2Vec2 *previous, const b2Vec2 *current, const SDL_FRect *rects, int count, float alpha, float xoffset, float yoffset, SDL_FRect *out);
+
+// Same as bodiesToScreen() for just the listed slots, each is written to out at its slot
+void bodiesToScreenAt(const b2Vec2 *previous, const b2Vec2 *current, const SDL_FRect *rects, const int *slots, int count, float alpha, float xoffset, float yoffset, SDL_FRect *out);
+
+// Converts SDL position of a rectangle with the given size to Box2d Position
+b2Vec2 SDLToBox2D(b2Vec2 vector, const SDL_FRect *rect);
 
 // Converts Box2D x,y to SDL x,y
 b2Vec2 Box2DXYToSDL(float x, float y);